@@ -72,6 +72,17 @@ InstBase* BasicBlock::GetFirstInst() const
 void BasicBlock::ClearImmDominator()
 {
     imm_dominator_ = nullptr;
+    dom_in_ = 0;
+    dom_out_ = 0;
+}
+
+void BasicBlock::SetDomNumbers(uint32_t in, uint32_t out)
+{
+    ASSERT(in != 0);
+    ASSERT(in < out);
+
+    dom_in_ = in;
+    dom_out_ = out;
 }
 
 bool BasicBlock::Dominates(BasicBlock* bb) const
@@ -82,6 +93,11 @@ bool BasicBlock::Dominates(BasicBlock* bb) const
         return true;
     }
 
+    // O(1) check for blocks, numbered by the same dominator tree walk
+    if (dom_in_ != 0 && bb->dom_in_ != 0) {
+        return dom_in_ < bb->dom_in_ && bb->dom_out_ < dom_out_;
+    }
+
     auto dom = bb->GetImmDominator();
     while (dom != nullptr) {
         if (dom == this) {
@@ -92,6 +108,40 @@ bool BasicBlock::Dominates(BasicBlock* bb) const
     return false;
 }
 
+void BasicBlock::UpdateInstOrder()
+{
+    if (inst_order_valid_) {
+        return;
+    }
+
+    uint32_t order = 0;
+    for (auto phi = GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        phi->SetOrder(order++);
+    }
+    for (auto inst = GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        inst->SetOrder(order++);
+    }
+
+    inst_order_valid_ = true;
+}
+
+void BasicBlock::InvalidateInstOrder()
+{
+    inst_order_valid_ = false;
+}
+
+void BasicBlock::SetLastInst(InstBase* inst)
+{
+    last_inst_ = inst;
+    InvalidateInstOrder();
+}
+
+void BasicBlock::SetLastPhi(InstBase* inst)
+{
+    last_phi_ = inst;
+    InvalidateInstOrder();
+}
+
 void BasicBlock::SetSuccsessor(unsigned pos, BasicBlock* bb)
 {
     ASSERT(bb != nullptr);
@@ -182,6 +232,7 @@ void BasicBlock::PushBackInst(std::unique_ptr<InstBase> inst)
     ASSERT(inst != nullptr);
     ASSERT(!inst->IsPhi());
 
+    InvalidateInstOrder();
     inst->SetBasicBlock(this);
     if (last_inst_ == nullptr) {
         SetFirstInst(std::move(inst));
@@ -197,6 +248,7 @@ void BasicBlock::PushFrontInst(std::unique_ptr<InstBase> inst)
     ASSERT(inst != nullptr);
     ASSERT(!inst->IsPhi());
 
+    InvalidateInstOrder();
     inst->SetBasicBlock(this);
     if (first_inst_ == nullptr) {
         SetFirstInst(std::move(inst));
@@ -218,6 +270,7 @@ void BasicBlock::InsertInst(std::unique_ptr<InstBase> inst, InstBase* left, Inst
     ASSERT(left->GetNext()->GetId() == right->GetId());
     ASSERT(right->GetPrev()->GetId() == left->GetId());
 
+    InvalidateInstOrder();
     inst->SetBasicBlock(this);
     inst->SetNext(left->ReleaseNext());
     inst->SetPrev(left);
@@ -249,11 +302,24 @@ void BasicBlock::InsertInstBefore(std::unique_ptr<InstBase> inst, InstBase* befo
     }
 }
 
+void BasicBlock::InsertInstBeforeTerminator(std::unique_ptr<InstBase> inst)
+{
+    ASSERT(inst != nullptr);
+
+    auto last = GetLastInst();
+    if (last != nullptr && last->HasFlag<isa::flag::Type::BRANCH>()) {
+        InsertInstBefore(std::move(inst), last);
+    } else {
+        PushBackInst(std::move(inst));
+    }
+}
+
 void BasicBlock::PushBackPhi(std::unique_ptr<InstBase> inst)
 {
     ASSERT(inst != nullptr);
     ASSERT(inst->IsPhi());
 
+    InvalidateInstOrder();
     inst->SetBasicBlock(this);
     if (first_phi_ == nullptr) {
         first_phi_ = std::move(inst);
@@ -270,6 +336,7 @@ void BasicBlock::PushBackPhi(InstBase* inst)
     ASSERT(inst != nullptr);
     ASSERT(inst->IsPhi());
 
+    InvalidateInstOrder();
     inst->SetBasicBlock(this);
     if (first_phi_ == nullptr) {
         first_phi_.reset(inst);
@@ -338,6 +405,47 @@ void BasicBlock::UnlinkInst(InstBase* inst)
     }
 }
 
+void BasicBlock::RemovePhiInputs(BasicBlock* pred)
+{
+    ASSERT(pred != nullptr);
+
+    for (auto phi = GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        auto inputs = phi->GetInputs();
+
+        // users are removed for all inputs, since one value may come from several blocks
+        for (const auto& input : inputs) {
+            input.GetInst()->RemoveUser(phi);
+        }
+        phi->ClearInputs();
+
+        for (const auto& input : inputs) {
+            if (input.GetSourceBB() != pred) {
+                phi->AddInput(input);
+            }
+        }
+    }
+}
+
+void BasicBlock::ReplacePhiSource(BasicBlock* old_pred, BasicBlock* new_pred)
+{
+    ASSERT(old_pred != nullptr);
+    ASSERT(new_pred != nullptr);
+
+    for (auto phi = GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        auto inputs = phi->GetInputs();
+
+        for (const auto& input : inputs) {
+            input.GetInst()->RemoveUser(phi);
+        }
+        phi->ClearInputs();
+
+        for (const auto& input : inputs) {
+            auto source = (input.GetSourceBB() == old_pred) ? new_pred : input.GetSourceBB();
+            phi->AddInput(input.GetInst(), source);
+        }
+    }
+}
+
 InstBase* BasicBlock::TransferInst()
 {
     last_inst_ = nullptr;
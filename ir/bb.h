@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "inst_fwd.h"
 #include "loop.h"
 #include "typedefs.h"
 #include "utils/macros.h"
@@ -17,7 +18,6 @@
 #include "isa/isa.h"
 
 class Graph;
-class InstBase;
 
 class BasicBlock : public marker::Markable
 {
@@ -43,8 +43,10 @@ class BasicBlock : public marker::Markable
         return succ;
     }
 
-    GETTER_SETTER(LastInst, InstBase*, last_inst_);
-    GETTER_SETTER(LastPhi, InstBase*, last_phi_);
+    GETTER(LastInst, last_inst_);
+    GETTER(LastPhi, last_phi_);
+    void SetLastInst(InstBase* inst);
+    void SetLastPhi(InstBase* inst);
     GETTER_SETTER(Id, IdType, id_);
     GETTER_SETTER(ImmDominator, BasicBlock*, imm_dominator_);
     GETTER(Loop, loop_);
@@ -70,8 +72,14 @@ class BasicBlock : public marker::Markable
     InstBase* GetFirstInst() const;
 
     void ClearImmDominator();
+    // entry and exit numbers of the block in dominator tree walk, 0 if block is not numbered
+    void SetDomNumbers(uint32_t in, uint32_t out);
     bool Dominates(BasicBlock* bb) const;
 
+    // numbers phis and instructions in order, if list was modified since last numbering
+    void UpdateInstOrder();
+    void InvalidateInstOrder();
+
     bool IsEmpty() const;
     bool IsStartBlock() const;
     bool IsEndBlock() const;
@@ -81,10 +89,16 @@ class BasicBlock : public marker::Markable
     void InsertInst(std::unique_ptr<InstBase> inst, InstBase* left, InstBase* right);
     void InsertInstAfter(std::unique_ptr<InstBase> inst, InstBase* after);
     void InsertInstBefore(std::unique_ptr<InstBase> inst, InstBase* before);
+    // inserts before the branch, that ends the block, or pushes back if there is none
+    void InsertInstBeforeTerminator(std::unique_ptr<InstBase> inst);
     void PushBackPhi(std::unique_ptr<InstBase> inst);
     void PushBackPhi(InstBase* inst);
 
     void UnlinkInst(InstBase* inst);
+    // removes inputs of phis, incoming from pred
+    void RemovePhiInputs(BasicBlock* pred);
+    // inputs of phis, incoming from old_pred, are marked as incoming from new_pred
+    void ReplacePhiSource(BasicBlock* old_pred, BasicBlock* new_pred);
     InstBase* TransferInst();
     InstBase* TransferPhi();
 
@@ -128,6 +142,10 @@ class BasicBlock : public marker::Markable
     std::array<BasicBlock*, MaxBranchNum::value> succs_{}; // successors
 
     BasicBlock* imm_dominator_{ nullptr };
+    uint32_t dom_in_{ 0 };
+    uint32_t dom_out_{ 0 };
+
+    bool inst_order_valid_{ false };
 
     IdType id_;
 
@@ -0,0 +1,164 @@
+#include "call_graph.h"
+#include "bb.h"
+
+#include <algorithm>
+
+CallGraph::CallGraph(const std::vector<Graph*>& graphs) : roots_{ graphs }
+{
+    Build();
+}
+
+void CallGraph::Build()
+{
+    ResetState();
+
+    for (auto graph : roots_) {
+        AddGraph(graph);
+    }
+
+    // graphs_ grows while callees are discovered
+    for (size_t i = 0; i < graphs_.size(); ++i) {
+        CollectCalls(graphs_[i]);
+    }
+
+    FindSCCs();
+}
+
+bool CallGraph::Contains(Graph* graph) const
+{
+    return nodes_.count(graph) != 0;
+}
+
+const std::vector<Graph*>& CallGraph::GetCallees(Graph* graph) const
+{
+    ASSERT(Contains(graph));
+    return nodes_.at(graph).callees;
+}
+
+const std::vector<Graph*>& CallGraph::GetCallers(Graph* graph) const
+{
+    ASSERT(Contains(graph));
+    return nodes_.at(graph).callers;
+}
+
+const std::vector<InstBase*>& CallGraph::GetCallSites(Graph* graph) const
+{
+    ASSERT(Contains(graph));
+    return nodes_.at(graph).call_sites;
+}
+
+std::vector<Graph*> CallGraph::GetBottomUpOrder() const
+{
+    std::vector<Graph*> res{};
+    res.reserve(graphs_.size());
+
+    for (const auto& scc : sccs_) {
+        res.insert(res.end(), scc.begin(), scc.end());
+    }
+
+    return res;
+}
+
+bool CallGraph::IsRecursive(Graph* graph) const
+{
+    ASSERT(Contains(graph));
+    const auto& node = nodes_.at(graph);
+    return node.has_self_call || sccs_[node.scc].size() > 1;
+}
+
+void CallGraph::ResetState()
+{
+    graphs_.clear();
+    nodes_.clear();
+    sccs_.clear();
+    scc_state_.clear();
+    scc_stack_.clear();
+    scc_index_ = 0;
+}
+
+void CallGraph::AddGraph(Graph* graph)
+{
+    ASSERT(graph != nullptr);
+
+    if (Contains(graph)) {
+        return;
+    }
+
+    nodes_[graph] = Node{};
+    graphs_.push_back(graph);
+}
+
+void CallGraph::CollectCalls(Graph* graph)
+{
+    using CallStaticT = isa::inst::Inst<isa::inst::Opcode::CALL_STATIC>::Type;
+
+    for (auto bb : graph->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            if (inst->GetOpcode() != isa::inst::Opcode::CALL_STATIC) {
+                continue;
+            }
+
+            auto callee = static_cast<CallStaticT*>(inst)->GetCallee();
+            if (callee == nullptr) {
+                continue;
+            }
+
+            AddGraph(callee);
+            nodes_.at(graph).call_sites.push_back(inst);
+
+            if (callee == graph) {
+                nodes_.at(graph).has_self_call = true;
+            }
+
+            auto& callees = nodes_.at(graph).callees;
+            if (std::find(callees.begin(), callees.end(), callee) == callees.end()) {
+                callees.push_back(callee);
+                nodes_.at(callee).callers.push_back(graph);
+            }
+        }
+    }
+}
+
+// tarjan's algorithm emits components in reverse topological order, that is callees first
+void CallGraph::FindSCCs()
+{
+    for (auto graph : graphs_) {
+        if (scc_state_.count(graph) == 0) {
+            StrongConnect(graph);
+        }
+    }
+}
+
+void CallGraph::StrongConnect(Graph* graph)
+{
+    // references to elements of unordered_map stay valid after insertions
+    auto& state = scc_state_[graph];
+    state = SCCState{ scc_index_, scc_index_, true };
+    ++scc_index_;
+    scc_stack_.push_back(graph);
+
+    for (auto callee : nodes_.at(graph).callees) {
+        if (scc_state_.count(callee) == 0) {
+            StrongConnect(callee);
+            state.low = std::min(state.low, scc_state_.at(callee).low);
+        } else if (scc_state_.at(callee).on_stack) {
+            state.low = std::min(state.low, scc_state_.at(callee).index);
+        }
+    }
+
+    if (state.low != state.index) {
+        return;
+    }
+
+    std::vector<Graph*> scc{};
+    Graph* member{ nullptr };
+    do {
+        member = scc_stack_.back();
+        scc_stack_.pop_back();
+        scc_state_.at(member).on_stack = false;
+        nodes_.at(member).scc = sccs_.size();
+        scc.push_back(member);
+    } while (member != graph);
+
+    sccs_.push_back(std::move(scc));
+}
@@ -0,0 +1,84 @@
+#ifndef ___CALL_GRAPH_H_INCLUDED___
+#define ___CALL_GRAPH_H_INCLUDED___
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "graph.h"
+#include "utils/macros.h"
+
+class InstBase;
+
+// module-level view of static calls between graphs. graphs, reachable from the given ones
+// through static calls, are added to the module as well.
+//
+// strongly connected components are computed in bottom-up order: callees come before their
+// callers, mutually recursive graphs share one component
+class CallGraph
+{
+  public:
+    explicit CallGraph(const std::vector<Graph*>& graphs);
+
+    NO_COPY_SEMANTIC(CallGraph);
+    NO_MOVE_SEMANTIC(CallGraph);
+
+    // recollects calls and components, should be called after graphs were modified
+    void Build();
+
+    bool Contains(Graph* graph) const;
+    // unique callees from the module in order of first call
+    const std::vector<Graph*>& GetCallees(Graph* graph) const;
+    const std::vector<Graph*>& GetCallers(Graph* graph) const;
+    const std::vector<InstBase*>& GetCallSites(Graph* graph) const;
+
+    GETTER(SCCs, sccs_);
+    // graphs of the module, callees before callers
+    std::vector<Graph*> GetBottomUpOrder() const;
+    // true if graph calls itself directly or through other graphs
+    bool IsRecursive(Graph* graph) const;
+
+    // runs passes on each graph of the module, so callees are optimized before they are inlined
+    template <typename... PassesT>
+    void RunBottomUp()
+    {
+        for (auto graph : GetBottomUpOrder()) {
+            (graph->GetPassManager()->template Run<PassesT>(), ...);
+        }
+    }
+
+  private:
+    struct Node
+    {
+        std::vector<InstBase*> call_sites{};
+        std::vector<Graph*> callees{};
+        std::vector<Graph*> callers{};
+        size_t scc{ 0 };
+        bool has_self_call{ false };
+    };
+
+    struct SCCState
+    {
+        size_t index{ 0 };
+        size_t low{ 0 };
+        bool on_stack{ false };
+    };
+
+    void ResetState();
+    void AddGraph(Graph* graph);
+    void CollectCalls(Graph* graph);
+    void FindSCCs();
+    void StrongConnect(Graph* graph);
+
+    std::vector<Graph*> roots_{};
+    // graphs in order of discovery, keeps results independent of hashing
+    std::vector<Graph*> graphs_{};
+    std::unordered_map<Graph*, Node> nodes_{};
+    std::vector<std::vector<Graph*> > sccs_{};
+
+    std::unordered_map<Graph*, SCCState> scc_state_{};
+    std::vector<Graph*> scc_stack_{};
+    size_t scc_index_{ 0 };
+};
+
+#endif
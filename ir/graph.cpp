@@ -1,6 +1,8 @@
 #include "graph.h"
 #include "bb.h"
 
+#include <unordered_set>
+
 using BranchFlag = isa::flag::Flag<isa::flag::BRANCH>;
 
 Graph::Graph() : pass_mgr_{ this }
@@ -63,14 +65,18 @@ void Graph::Dump(std::string name)
 void Graph::ClearDominators()
 {
     for (const auto& bb : bb_vector_) {
-        bb->ClearImmDominator();
+        if (bb != nullptr) {
+            bb->ClearImmDominator();
+        }
     }
 }
 
 void Graph::ClearLoops()
 {
     for (const auto& bb : bb_vector_) {
-        bb->SetLoop(nullptr);
+        if (bb != nullptr) {
+            bb->SetLoop(nullptr);
+        }
     }
 }
 
@@ -189,6 +195,32 @@ void Graph::InvertCondition(BasicBlock* bb)
     UNREACHABLE("trying to invert condition in an instruction with no condition");
 }
 
+void Graph::ReplaceBranchWithJump(BasicBlock* bb, BasicBlock* target)
+{
+    ASSERT(bb->GetNumSuccessors() == BranchFlag::Value::TWO_SUCCESSORS);
+    ASSERT(bb->GetLastInst() != nullptr);
+    ASSERT(bb->GetLastInst()->IsConditional());
+
+    auto branch = bb->GetLastInst();
+    auto succ_true = bb->GetSuccessor(Conditional::Branch::BRANCH_TRUE);
+    auto succ_false = bb->GetSuccessor(Conditional::Branch::FALLTHROUGH);
+    ASSERT(target == succ_true || target == succ_false);
+    auto other = (target == succ_true) ? succ_false : succ_true;
+
+    other->RemovePhiInputs(bb);
+    for (auto input : branch->GetInputInsts()) {
+        input->RemoveUser(branch);
+    }
+
+    // the only successor should be in the first slot
+    ReplaceSuccessor(bb, succ_true, nullptr);
+    if (target == succ_true) {
+        ReplaceSuccessor(bb, succ_false, target);
+    }
+
+    bb->UnlinkInst(branch);
+}
+
 BasicBlock* Graph::SplitBasicBlock(InstBase* inst_after)
 {
     ASSERT(inst_after != nullptr);
@@ -231,3 +263,50 @@ void Graph::DestroyBasicBlock(BasicBlock* bb)
 
     pass_mgr_.InvalidateCFGSensitiveActivePasses();
 }
+
+std::vector<BasicBlock*> Graph::RemoveUnreachableBlocks()
+{
+    auto rpo = pass_mgr_.GetValidPass<RPO>()->GetBlocks();
+    std::unordered_set<BasicBlock*> reachable{ rpo.begin(), rpo.end() };
+
+    std::vector<BasicBlock*> unreachable{};
+    for (const auto& bb : bb_vector_) {
+        if (bb != nullptr && reachable.count(bb.get()) == 0) {
+            unreachable.push_back(bb.get());
+        }
+    }
+
+    // values of unreachable blocks may only be used by unreachable blocks and by phis
+    for (auto bb : unreachable) {
+        for (auto inst = bb->GetFirstPhi(); inst != nullptr; inst = inst->GetNext()) {
+            for (auto input : inst->GetInputInsts()) {
+                input->RemoveUser(inst);
+            }
+        }
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            for (auto input : inst->GetInputInsts()) {
+                input->RemoveUser(inst);
+            }
+        }
+    }
+
+    std::vector<BasicBlock*> affected{};
+    for (auto bb : unreachable) {
+        auto succs = bb->GetSuccessors();
+        // successors are removed starting from the last slot to keep the rest of them valid
+        for (auto it = succs.rbegin(); it != succs.rend(); ++it) {
+            if (reachable.count(*it) != 0) {
+                (*it)->RemovePhiInputs(bb);
+                affected.push_back(*it);
+            }
+            ReplaceSuccessor(bb, *it, nullptr);
+        }
+    }
+
+    for (auto bb : unreachable) {
+        ASSERT(bb->HasNoPredecessors());
+        DestroyBasicBlock(bb);
+    }
+
+    return affected;
+}
@@ -10,6 +10,7 @@
 
 #include "bb.h"
 #include "pass/pass_manager.h"
+#include "profile.h"
 #include "typedefs.h"
 
 class InstBase;
@@ -34,6 +35,9 @@ class Graph
     void InsertBasicBlockBefore(BasicBlock* bb, BasicBlock* before);
     void ReplaceSuccessor(BasicBlock* bb, BasicBlock* prev_succ, BasicBlock* new_succ);
     void InvertCondition(BasicBlock* bb);
+    // conditional branch of bb is removed, bb falls through to target, that must be one of
+    // it's successors. phi inputs from bb are removed from the other successor
+    void ReplaceBranchWithJump(BasicBlock* bb, BasicBlock* target);
     void SwapTwoSuccessors(BasicBlock* bb);
 
     BasicBlock* SplitBasicBlock(InstBase* inst_after);
@@ -45,6 +49,9 @@ class Graph
     BasicBlock* ReleaseBasicBlock(IdType id);
     // null basic block, invalidate previous pointer
     void DestroyBasicBlock(BasicBlock* bb);
+    // destroys blocks, that are not reachable from the start block, and their instructions.
+    // returns reachable blocks, that lost predecessors
+    std::vector<BasicBlock*> RemoveUnreachableBlocks();
 
     void Dump(std::string name = "");
 
@@ -53,6 +60,11 @@ class Graph
         return &pass_mgr_;
     }
 
+    Profile* GetProfile()
+    {
+        return &profile_;
+    }
+
   private:
     void InitStartBlock();
 
@@ -62,7 +74,7 @@ class Graph
 
     PassManager pass_mgr_;
 
-    // Metadata metadata;
+    Profile profile_{};
 };
 
 #endif
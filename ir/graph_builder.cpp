@@ -223,6 +223,8 @@ bool GraphBuilder::RunChecks()
     // check inputs of variable length
     auto analyser = graph_->GetPassManager();
     auto rpo = analyser->GetValidPass<RPO>()->GetBlocks();
+    // phi inputs are checked against dominators
+    analyser->GetValidPass<DomTree>();
     for (auto bb : rpo) {
         for (unsigned i = 0; i < bb->GetNumSuccessors(); ++i) {
             if (bb->GetSuccessor(i) == nullptr) {
@@ -0,0 +1,170 @@
+#include "graph_cloner.h"
+#include "bb.h"
+#include "graph.h"
+#include "loop.h"
+
+void GraphCloner::MapValue(InstBase* from, InstBase* to)
+{
+    ASSERT(from != nullptr);
+    ASSERT(to != nullptr);
+
+    insts_[from] = to;
+}
+
+void GraphCloner::MapBlock(BasicBlock* from, BasicBlock* to)
+{
+    ASSERT(from != nullptr);
+    ASSERT(to != nullptr);
+
+    blocks_[from] = to;
+}
+
+void GraphCloner::Skip(InstBase* inst)
+{
+    ASSERT(inst != nullptr);
+
+    skipped_.insert(inst);
+}
+
+void GraphCloner::CloneBlocks(const std::vector<BasicBlock*>& blocks)
+{
+    for (auto bb : blocks) {
+        ASSERT(bb != nullptr);
+        if (blocks_.count(bb) == 0) {
+            blocks_[bb] = graph_->NewBasicBlock();
+        }
+    }
+
+    // inputs are set after all instructions are cloned, because of phis and back edges
+    auto first = cloned_.size();
+    for (auto bb : blocks) {
+        CloneInsts(bb);
+    }
+
+    for (auto i = first; i < cloned_.size(); ++i) {
+        CloneInputs(cloned_[i].first, cloned_[i].second);
+    }
+
+    for (auto bb : blocks) {
+        CloneEdges(bb);
+    }
+}
+
+static void CollectLoopBlocks(const Loop* loop, std::vector<BasicBlock*>* blocks)
+{
+    blocks->push_back(loop->GetHeader());
+
+    auto loop_blocks = loop->GetBlocks();
+    blocks->insert(blocks->end(), loop_blocks.begin(), loop_blocks.end());
+
+    for (auto inner : loop->GetInnerLoops()) {
+        CollectLoopBlocks(inner, blocks);
+    }
+}
+
+void GraphCloner::CloneLoop(const Loop* loop)
+{
+    ASSERT(loop != nullptr);
+    ASSERT(!loop->IsRoot());
+
+    std::vector<BasicBlock*> blocks{};
+    CollectLoopBlocks(loop, &blocks);
+
+    CloneBlocks(blocks);
+}
+
+void GraphCloner::CloneGraph(Graph* graph)
+{
+    ASSERT(graph != nullptr);
+    ASSERT(graph != graph_);
+
+    CloneBlocks(graph->GetPassManager()->GetValidPass<RPO>()->GetBlocks());
+}
+
+BasicBlock* GraphCloner::GetClone(BasicBlock* bb) const
+{
+    auto it = blocks_.find(bb);
+    return (it == blocks_.end()) ? nullptr : it->second;
+}
+
+InstBase* GraphCloner::GetClone(InstBase* inst) const
+{
+    auto it = insts_.find(inst);
+    return (it == insts_.end()) ? inst : it->second;
+}
+
+void GraphCloner::CloneInsts(BasicBlock* bb)
+{
+    auto clone_bb = blocks_.at(bb);
+
+    for (auto phi = bb->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        if (insts_.count(phi) != 0 || skipped_.count(phi) != 0) {
+            continue;
+        }
+
+        auto clone = phi->Clone();
+        insts_[phi] = clone.get();
+        cloned_.emplace_back(phi, clone.get());
+        clone_bb->PushBackPhi(std::move(clone));
+    }
+
+    for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        if (insts_.count(inst) != 0 || skipped_.count(inst) != 0) {
+            continue;
+        }
+
+        auto clone = inst->Clone();
+        insts_[inst] = clone.get();
+        cloned_.emplace_back(inst, clone.get());
+        clone_bb->PushBackInst(std::move(clone));
+    }
+}
+
+void GraphCloner::CloneInputs(InstBase* inst, InstBase* clone)
+{
+    if (!inst->IsDynamic()) {
+        for (unsigned i = 0; i < inst->GetNumInputs(); ++i) {
+            auto input = inst->GetInput(i).GetInst();
+            ASSERT(skipped_.count(input) == 0);
+            clone->SetInput(i, GetClone(input));
+        }
+        return;
+    }
+
+    for (const auto& input : inst->GetInputs()) {
+        ASSERT(skipped_.count(input.GetInst()) == 0);
+
+        auto value = GetClone(input.GetInst());
+        if (!inst->IsPhi()) {
+            clone->AddInput(value, value->GetBasicBlock());
+            continue;
+        }
+
+        auto source = GetClone(input.GetSourceBB());
+        clone->AddInput(value, (source == nullptr) ? input.GetSourceBB() : source);
+    }
+}
+
+// edges are added in order of bb's predecessors to keep the same predecessors order
+void GraphCloner::CloneEdges(BasicBlock* bb)
+{
+    auto clone_bb = blocks_.at(bb);
+
+    for (auto pred : bb->GetPredecessors()) {
+        auto clone_pred = GetClone(pred);
+        if (clone_pred == nullptr) {
+            continue;
+        }
+
+        auto last = pred->GetLastInst();
+        if (last != nullptr && skipped_.count(last) != 0) {
+            continue;
+        }
+
+        for (unsigned slot = 0; slot < pred->GetNumSuccessors(); ++slot) {
+            if (pred->GetSuccessor(slot) == bb) {
+                graph_->AddEdge(clone_pred, clone_bb, slot);
+            }
+        }
+    }
+}
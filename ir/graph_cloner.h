@@ -0,0 +1,65 @@
+#ifndef ___GRAPH_CLONER_H_INCLUDED___
+#define ___GRAPH_CLONER_H_INCLUDED___
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "utils/macros.h"
+
+class Graph;
+class BasicBlock;
+class InstBase;
+class Loop;
+
+// copies blocks with their instructions into graph. inputs of cloned instructions are remapped
+// to clones, values defined outside of the cloned region are used as is unless mapped
+// explicitly. source blocks and instructions are not modified, so the same region (or another
+// graph) may be cloned any number of times.
+//
+// edges between blocks cloned by the same call are recreated. edges to blocks, that were not
+// cloned, edges of blocks with skipped terminator and phi inputs from blocks, that were not
+// cloned, are left for the user to fix
+class GraphCloner
+{
+  public:
+    explicit GraphCloner(Graph* graph) : graph_{ graph }
+    {
+    }
+
+    NO_COPY_SEMANTIC(GraphCloner);
+    NO_MOVE_SEMANTIC(GraphCloner);
+
+    // uses of from are replaced with to. from is not cloned
+    void MapValue(InstBase* from, InstBase* to);
+    // instructions of from are cloned into existing block to
+    void MapBlock(BasicBlock* from, BasicBlock* to);
+    // inst is not cloned. cloned instructions should not use it
+    void Skip(InstBase* inst);
+
+    void CloneBlocks(const std::vector<BasicBlock*>& blocks);
+    // clones header and blocks of the loop and of it's inner loops
+    void CloneLoop(const Loop* loop);
+    // clones blocks of another graph, that are reachable from it's start block
+    void CloneGraph(Graph* graph);
+
+    // nullptr if bb was not cloned
+    BasicBlock* GetClone(BasicBlock* bb) const;
+    // inst itself if inst was neither cloned nor mapped
+    InstBase* GetClone(InstBase* inst) const;
+
+  private:
+    void CloneInsts(BasicBlock* bb);
+    void CloneInputs(InstBase* inst, InstBase* clone);
+    void CloneEdges(BasicBlock* bb);
+
+    Graph* graph_;
+
+    std::unordered_map<BasicBlock*, BasicBlock*> blocks_{};
+    std::unordered_map<InstBase*, InstBase*> insts_{};
+    std::unordered_set<InstBase*> skipped_{};
+    std::vector<std::pair<InstBase*, InstBase*> > cloned_{};
+};
+
+#endif
@@ -3,39 +3,76 @@
 
 #include <vector>
 
+#include "bb.h"
+#include "inst.h"
 #include "isa/isa.h"
 #include "utils/macros.h"
 
-class Graph;
-class BasicBlock;
-class InstBase;
-
+// compile time visitor over graph instructions. Derived provides
+//     std::vector<BasicBlock*> BlockOrder() const;
+// and hides Visit<OPCODE>(InstBase*) handlers for the opcodes it is interested in, all other
+// opcodes go to VisitDefault. handlers are resolved statically through the opcode switch, so
+// they are inlined into the visiting loop. Derived should befriend GraphVisitor<Derived>, if
+// handlers are private
+template <typename Derived>
 class GraphVisitor
 {
   public:
-    DEFAULT_CTOR(GraphVisitor);
-    virtual ~GraphVisitor() = default;
+    void VisitGraph()
+    {
+        for (auto bb : Self()->BlockOrder()) {
+            Self()->VisitBasicBlock(bb);
+        }
+    }
 
-    NO_MOVE_SEMANTIC(GraphVisitor);
-    NO_COPY_SEMANTIC(GraphVisitor);
+    void VisitBasicBlock(BasicBlock* bb)
+    {
+        for (auto i = bb->GetFirstInst(); i != nullptr; i = i->GetNext()) {
+            VisitInstruction(i);
+        }
+        for (auto i = bb->GetFirstPhi(); i != nullptr; i = i->GetNext()) {
+            VisitInstruction(i);
+        }
+    }
 
-    virtual std::vector<BasicBlock*> BlockOrder() const = 0;
+    void VisitInstruction(InstBase* inst)
+    {
+        switch (inst->GetOpcode()) {
+#define GEN_DISPATCH(OPCODE, ...)                                                                 \
+    case isa::inst::Opcode::OPCODE:                                                               \
+        Self()->Visit##OPCODE(inst);                                                              \
+        break;
+            ISA_INSTRUCTION_LIST(GEN_DISPATCH)
+#undef GEN_DISPATCH
+        default:
+            UNREACHABLE("trying to visit instruction with unknown opcode");
+        }
+    }
 
-    virtual void VisitGraph() = 0;
-    virtual void VisitBasicBlock(BasicBlock* bb) = 0;
-    virtual void VisitInstruction(InstBase* inst) = 0;
+  protected:
+    DEFAULT_CTOR(GraphVisitor);
+    DEFAULT_DTOR(GraphVisitor);
+    NO_COPY_SEMANTIC(GraphVisitor);
+    NO_MOVE_SEMANTIC(GraphVisitor);
 
-#define GEN_INST_TYPE_VISITORS_DECL(TYPE, ...) virtual void VisitInstType(isa::inst_type::TYPE* i);
-    ISA_INSTRUCTION_TYPE_LIST(GEN_INST_TYPE_VISITORS_DECL)
-#undef GEN_INST_TYPE_VISITORS_DECL
+    void VisitDefault(InstBase* inst)
+    {
+        (void)(inst);
+    }
 
-  protected:
-    virtual void VisitDefault(InstBase* inst);
+#define GEN_DEFAULT_VISITORS(OPCODE, ...)                                                         \
+    void Visit##OPCODE(InstBase* inst)                                                            \
+    {                                                                                             \
+        Self()->VisitDefault(inst);                                                               \
+    }
+    ISA_INSTRUCTION_LIST(GEN_DEFAULT_VISITORS)
+#undef GEN_DEFAULT_VISITORS
 
-#define GEN_OPCODE_VISITORS_DECL(OPCODE, ...)                                                     \
-    static void Visit##OPCODE(GraphVisitor* v, InstBase* i);
-    ISA_INSTRUCTION_LIST(GEN_OPCODE_VISITORS_DECL)
-#undef GEN_OPCODE_VISITORS_DECL
+  private:
+    Derived* Self()
+    {
+        return static_cast<Derived*>(this);
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
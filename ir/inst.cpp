@@ -1,4 +1,6 @@
 #include <array>
+#include <cmath>
+#include <limits>
 #include <sstream>
 
 #include "bb.h"
@@ -21,6 +23,11 @@ bool Location::IsOnRegister()
     return loc == Location::Where::REGISTER;
 }
 
+bool Location::IsRematerialized()
+{
+    return loc == Location::Where::REMAT;
+}
+
 bool Location::IsUnset()
 {
     return loc == Location::Where::UNSET;
@@ -40,6 +47,9 @@ std::ostream& operator<<(std::ostream& os, const Location& l)
     case Location::Where::STACK:
         os << "S" << l.slot;
         break;
+    case Location::Where::REMAT:
+        os << "REMAT";
+        break;
     case Location::Where::UNSET:
         os << "UNSET";
         break;
@@ -55,11 +65,26 @@ std::ostream& operator<<(std::ostream& os, const Location& l)
 // ====================
 // InstBase
 
+using PhiT = isa::inst::Inst<isa::inst::Opcode::PHI>::Type;
+
 Input InstBase::GetInput(unsigned idx) const
 {
     ASSERT(idx < GetNumInputs());
 
-    return inputs_[idx];
+    auto inst = inputs_[idx];
+    if (IsPhi()) {
+        return Input(inst, static_cast<const PhiT*>(this)->sources_[idx]);
+    }
+    return Input(inst, (inst == nullptr) ? nullptr : inst->GetBasicBlock());
+}
+
+InstBase::Inputs InstBase::GetInputs() const
+{
+    Inputs inputs{};
+    for (unsigned i = 0; i < inputs_.size(); ++i) {
+        inputs.push_back(GetInput(i));
+    }
+    return inputs;
 }
 
 void InstBase::SetInput(unsigned idx, InstBase* inst)
@@ -69,7 +94,7 @@ void InstBase::SetInput(unsigned idx, InstBase* inst)
     ASSERT(idx < GetNumInputs());
 
     inst->users_.push_back(User(this, idx));
-    inputs_[idx] = Input(inst, inst->GetBasicBlock());
+    inputs_[idx] = inst;
 }
 
 void InstBase::SetInput(unsigned idx, InstBase* inst, BasicBlock* bb)
@@ -79,10 +104,27 @@ void InstBase::SetInput(unsigned idx, InstBase* inst, BasicBlock* bb)
     ASSERT(idx < GetNumInputs());
 
     inst->users_.push_back(User(this, idx));
-    inputs_[idx] = Input(inst, bb);
+    inputs_[idx] = inst;
+    if (IsPhi()) {
+        static_cast<PhiT*>(this)->sources_[idx] = bb;
+    }
 }
 
 void InstBase::Dump() const
+{
+    switch (opcode_) {
+#define GENERATOR(OPCODE, ...)                                                                    \
+    case isa::inst::Opcode::OPCODE:                                                               \
+        static_cast<const isa::inst::Inst<isa::inst::Opcode::OPCODE>::Type*>(this)->DumpImpl();   \
+        return;
+        ISA_INSTRUCTION_LIST(GENERATOR)
+#undef GENERATOR
+    default:
+        UNREACHABLE("trying to dump instruction with unknown opcode");
+    }
+}
+
+void InstBase::DumpImpl() const
 {
     static const std::array<std::string, isa::inst::Opcode::N_OPCODES> OP_TO_STR{
 #define CREATE(OPCODE, ...) #OPCODE,
@@ -120,11 +162,11 @@ void InstBase::Dump() const
 
     std::cout << "#\tinst inputs:\n#\t\t[";
     if (!IsPhi()) {
-        for (auto input : inputs_) {
-            std::cout << input.GetInst()->GetId() << " ";
+        for (auto input : GetInputInsts()) {
+            std::cout << input->GetId() << " ";
         }
     } else {
-        for (auto input : inputs_) {
+        for (auto input : GetInputs()) {
             std::cout << input.GetInst()->GetId() << "(bb: " << input.GetSourceBB()->GetId() << ")"
                       << " ";
         }
@@ -139,17 +181,36 @@ void InstBase::AddInput(InstBase* inst, BasicBlock* bb)
     ASSERT(IsDynamic());
 
     inst->AddUser(this);
-    inputs_.emplace_back(Input(inst, bb));
+    inputs_.push_back(inst);
+    if (IsPhi()) {
+        static_cast<PhiT*>(this)->sources_.push_back(bb);
+    }
 }
 
 void InstBase::AddInput(const Input& input)
 {
-    ASSERT(input.GetInst() != nullptr);
-    ASSERT(input.GetSourceBB() != nullptr);
-    ASSERT(IsDynamic());
+    AddInput(input.GetInst(), input.GetSourceBB());
+}
+
+InstBase* InstBase::GetPhiInput(const BasicBlock* bb) const
+{
+    auto sources = GetPhiSources();
+    for (unsigned i = 0; i < sources.size(); ++i) {
+        if (sources[i] == bb) {
+            return inputs_[i];
+        }
+    }
 
-    input.GetInst()->AddUser(this);
-    inputs_.push_back(input);
+    UNREACHABLE("phi has no input from the block");
+    return nullptr;
+}
+
+std::span<BasicBlock* const> InstBase::GetPhiSources() const
+{
+    ASSERT(IsPhi());
+
+    const auto& sources = static_cast<const PhiT*>(this)->sources_;
+    return { sources.data(), sources.size() };
 }
 
 void InstBase::ClearInputs()
@@ -157,16 +218,36 @@ void InstBase::ClearInputs()
     ASSERT(IsDynamic());
 
     inputs_.clear();
+    if (IsPhi()) {
+        static_cast<PhiT*>(this)->sources_.clear();
+    }
 }
 
 void InstBase::RemoveInput(const Input& input) noexcept
 {
     ASSERT(IsDynamic());
 
-    std::erase_if(inputs_, [input](const Input& i) noexcept {
-        return (i.GetSourceBB()->GetId() == input.GetSourceBB()->GetId() &&
-                i.GetInst()->GetId() == input.GetInst()->GetId());
-    });
+    // phi sources are compacted together with inputs
+    auto sources = IsPhi() ? &static_cast<PhiT*>(this)->sources_ : nullptr;
+    size_t size = 0;
+    for (unsigned i = 0; i < inputs_.size(); ++i) {
+        auto in = GetInput(i);
+        if (in.GetSourceBB()->GetId() == input.GetSourceBB()->GetId() &&
+            in.GetInst()->GetId() == input.GetInst()->GetId()) {
+            continue;
+        }
+
+        inputs_[size] = inputs_[i];
+        if (sources != nullptr) {
+            (*sources)[size] = (*sources)[i];
+        }
+        ++size;
+    }
+
+    inputs_.resize(size);
+    if (sources != nullptr) {
+        sources->resize(size);
+    }
 }
 
 void InstBase::ReplaceInput(InstBase* old_inst, InstBase* new_inst)
@@ -175,12 +256,9 @@ void InstBase::ReplaceInput(InstBase* old_inst, InstBase* new_inst)
     ASSERT(new_inst != nullptr);
 
     for (auto& input : inputs_) {
-        ASSERT(input.GetInst() != nullptr);
-        if (old_inst->GetId() == input.GetInst()->GetId()) {
-            if (!IsPhi()) {
-                input.SetSourceBB(new_inst->GetBasicBlock());
-            }
-            input.SetInst(new_inst);
+        ASSERT(input != nullptr);
+        if (old_inst->GetId() == input->GetId()) {
+            input = new_inst;
         }
     }
 }
@@ -256,6 +334,18 @@ void InstBase::ReplaceUser(const User& user_old, const User& user_new)
         user_new);
 }
 
+void InstBase::ReplaceUsers(InstBase* inst)
+{
+    ASSERT(inst != nullptr);
+    ASSERT(inst != this);
+
+    for (const auto& user : users_) {
+        inst->AddUser(user);
+        user.GetInst()->ReplaceInput(this, inst);
+    }
+    users_.clear();
+}
+
 InstBase* InstBase::GetNext() const
 {
     return next_.get();
@@ -286,6 +376,18 @@ bool InstBase::IsConst() const
     return opcode_ == isa::inst::Opcode::CONST;
 }
 
+bool InstBase::IsIntegralConst() const
+{
+    return IsConst() && data_type_ == DataType::INT;
+}
+
+int64_t InstBase::GetIntegralConst() const
+{
+    ASSERT(IsIntegralConst());
+    using ConstT = isa::inst::Inst<isa::inst::Opcode::CONST>::Type;
+    return static_cast<const ConstT*>(this)->GetValInt();
+}
+
 bool InstBase::IsParam() const
 {
     return opcode_ == isa::inst::Opcode::PARAM;
@@ -345,15 +447,8 @@ bool InstBase::Precedes(const InstBase* inst) const
         return true;
     }
 
-    auto next = GetNext();
-    while (next != nullptr) {
-        if (next->GetId() == inst->GetId()) {
-            return true;
-        }
-        next = next->GetNext();
-    }
-
-    return false;
+    GetBasicBlock()->UpdateInstOrder();
+    return GetOrder() < inst->GetOrder();
 }
 
 bool InstBase::Dominates(const InstBase* inst) const
@@ -375,9 +470,79 @@ bool InstBase::Dominates(const InstBase* inst) const
     return bb->Dominates(bb_inst);
 }
 
+template <isa::inst::Opcode OPCODE>
+static std::unique_ptr<InstBase> CloneT(const InstBase* inst)
+{
+    using T = typename isa::inst::Inst<OPCODE>::Type;
+    using NumImms = isa::InputValue<T, isa::input::Type::IMM>;
+
+    ASSERT(inst != nullptr);
+    ASSERT(inst->GetOpcode() == OPCODE);
+
+    auto orig = static_cast<const T*>(inst);
+    std::unique_ptr<InstBase> clone{ nullptr };
+
+    if constexpr (std::is_same_v<T, isa::inst_type::CALL>) {
+        clone = InstBase::NewInst<OPCODE>(orig->GetCallee());
+    } else if constexpr (std::is_same_v<T, isa::inst_type::CONST>) {
+        clone = InstBase::NewInst<OPCODE>(orig->GetValRaw());
+    } else if constexpr (std::is_base_of_v<Conditional, T>) {
+        clone = InstBase::NewInst<OPCODE>(orig->GetCondition());
+    } else {
+        clone = InstBase::NewInst<OPCODE>();
+    }
+
+    if constexpr (NumImms::value > 0) {
+        for (unsigned i = 0; i < NumImms::value; ++i) {
+            static_cast<T*>(clone.get())->SetImmediate(i, orig->GetImm(i));
+        }
+    }
+
+    clone->SetDataType(orig->GetDataType());
+
+    return clone;
+}
+
+std::unique_ptr<InstBase> InstBase::Clone() const
+{
+    switch (opcode_) {
+#define GENERATOR(OPCODE, ...)                                                                    \
+    case isa::inst::Opcode::OPCODE:                                                               \
+        return CloneT<isa::inst::Opcode::OPCODE>(this);
+        ISA_INSTRUCTION_LIST(GENERATOR)
+#undef GENERATOR
+    default:
+        UNREACHABLE("trying to clone instruction with unknown opcode");
+    }
+
+    return nullptr;
+}
+
 // InstBase
 // ====================
 
+#define GENERATOR(INST_TYPE, ...) STATIC_ASSERT(!std::is_polymorphic_v<isa::inst_type::INST_TYPE>);
+ISA_INSTRUCTION_TYPE_LIST(GENERATOR)
+#undef GENERATOR
+
+void std::default_delete<InstBase>::operator()(InstBase* inst) const noexcept
+{
+    if (inst == nullptr) {
+        return;
+    }
+
+    switch (inst->GetOpcode()) {
+#define GENERATOR(OPCODE, ...)                                                                    \
+    case isa::inst::Opcode::OPCODE:                                                               \
+        delete static_cast<isa::inst::Inst<isa::inst::Opcode::OPCODE>::Type*>(inst);              \
+        return;
+        ISA_INSTRUCTION_LIST(GENERATOR)
+#undef GENERATOR
+    default:
+        UNREACHABLE("trying to delete instruction with unknown opcode");
+    }
+}
+
 // ====================
 // Conditional
 
@@ -414,6 +579,84 @@ void Conditional::Invert()
     }
 }
 
+Conditional::Type Conditional::Inverse(Type cond)
+{
+    Conditional inverted{ cond };
+    inverted.Invert();
+    return inverted.GetCondition();
+}
+
+Conditional::Type Conditional::Swap(Type cond)
+{
+    switch (cond) {
+    case Type::LEQ:
+        return Type::GEQ;
+    case Type::GEQ:
+        return Type::LEQ;
+    case Type::L:
+        return Type::G;
+    case Type::G:
+        return Type::L;
+    default:
+        return cond;
+    }
+}
+
+bool Conditional::Evaluate(Type cond, int64_t lhs, int64_t rhs)
+{
+    switch (cond) {
+    case Type::EQ:
+        return lhs == rhs;
+    case Type::NEQ:
+        return lhs != rhs;
+    case Type::LEQ:
+        return lhs <= rhs;
+    case Type::GEQ:
+        return lhs >= rhs;
+    case Type::L:
+        return lhs < rhs;
+    case Type::G:
+        return lhs > rhs;
+    default:
+        UNREACHABLE("unhandled conditional code");
+        return false;
+    }
+}
+
+// fact implies query if every pair of values, that satisfies fact, satisfies query
+static bool ImpliesTrue(Conditional::Type fact, Conditional::Type query)
+{
+    using Type = Conditional::Type;
+
+    if (fact == query) {
+        return true;
+    }
+
+    switch (fact) {
+    case Type::EQ:
+        return query == Type::LEQ || query == Type::GEQ;
+    case Type::L:
+        return query == Type::LEQ || query == Type::NEQ;
+    case Type::G:
+        return query == Type::GEQ || query == Type::NEQ;
+    default:
+        return false;
+    }
+}
+
+std::optional<bool> Conditional::Implies(Type fact, Type query)
+{
+    if (ImpliesTrue(fact, query)) {
+        return true;
+    }
+
+    if (ImpliesTrue(fact, Inverse(query))) {
+        return false;
+    }
+
+    return std::nullopt;
+}
+
 void Conditional::Dump() const
 {
     std::stringstream ss;
@@ -458,6 +701,25 @@ void Conditional::Dump() const
 // ====================
 // WithImm
 
+std::optional<int64_t> ImmToIntegral(ImmType imm)
+{
+    // -2^63 and 2^63 are exact in ImmType, int64_t holds [-2^63, 2^63)
+    constexpr auto LIMIT = static_cast<ImmType>(std::numeric_limits<int64_t>::min());
+    if (!(imm >= LIMIT && imm < -LIMIT) || std::islessgreater(std::trunc(imm), imm)) {
+        return std::nullopt;
+    }
+    return static_cast<int64_t>(imm);
+}
+
+std::optional<ImmType> IntegralToImm(int64_t val)
+{
+    auto imm = static_cast<ImmType>(val);
+    if (ImmToIntegral(imm) != val) {
+        return std::nullopt;
+    }
+    return imm;
+}
+
 // WithImm
 // ====================
 
@@ -552,19 +814,19 @@ int64_t isa::inst_type::CONST::GetValInt() const
 
 float isa::inst_type::CONST::GetValFloat() const
 {
-    ASSERT(GetDataType() == InstBase::DataType::DOUBLE);
+    ASSERT(GetDataType() == InstBase::DataType::FLOAT);
     return std::bit_cast<float, uint32_t>(static_cast<uint32_t>(val_));
 }
 
 double isa::inst_type::CONST::GetValDouble() const
 {
-    ASSERT(GetDataType() == InstBase::DataType::FLOAT);
+    ASSERT(GetDataType() == InstBase::DataType::DOUBLE);
     return std::bit_cast<double, uint64_t>(val_);
 }
 
-void isa::inst_type::CONST::Dump() const
+void isa::inst_type::CONST::DumpImpl() const
 {
-    InstBase::Dump();
+    InstBase::DumpImpl();
     std::cout << "#\tconst value: " << GetValRaw() << "\n";
 }
 
@@ -8,18 +8,21 @@
 #include <list>
 #include <memory>
 #include <numeric>
+#include <optional>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <vector>
 
+#include "inst_fwd.h"
 #include "typedefs.h"
 #include "utils/bit_flag.h"
 #include "utils/macros.h"
 #include "utils/marker/markable.h"
+#include "utils/small_vector.h"
 
 #include "isa/isa.h"
 
-class InstBase;
 class BasicBlock;
 class Graph;
 class Input
@@ -63,6 +66,8 @@ struct Location
         UNSET,
         REGISTER,
         STACK,
+        // value is not stored anywhere and is recomputed at each use
+        REMAT,
     };
 
     Location(Where l, unsigned s);
@@ -73,6 +78,7 @@ struct Location
 
     bool IsOnStack();
     bool IsOnRegister();
+    bool IsRematerialized();
     bool IsUnset();
 
     bool operator==(const Location& other) const;
@@ -95,9 +101,17 @@ class InstBase : public marker::Markable
         ANY
     };
 
+    // inputs of fixed arity instructions are stored inline, only PHI and CALL with more inputs
+    // allocate heap storage. only input instructions are stored, source blocks of phi inputs
+    // are kept by PHI, for other instructions source block is the block of the input
+    using Inputs = SmallVector<Input, isa::MAX_FIXED_INPUTS>;
+
     template <isa::inst::Opcode OPCODE, typename... Args>
     static std::unique_ptr<InstBase> NewInst(Args&&... args);
-    virtual ~InstBase() = default;
+
+    // creates instruction with the same opcode, type, immediates, condition, callee and constant
+    // value. inputs, users and basic block are not copied
+    std::unique_ptr<InstBase> Clone() const;
 
     NO_COPY_SEMANTIC(InstBase);
     NO_MOVE_SEMANTIC(InstBase);
@@ -106,10 +120,20 @@ class InstBase : public marker::Markable
     GETTER_SETTER(BasicBlock, BasicBlock*, bb_);
     GETTER_SETTER(DataType, DataType, data_type_);
     GETTER(Opcode, opcode_);
-    GETTER(Inputs, inputs_);
+    // input instructions as they are stored, see GetPhiSources for source blocks of phi inputs
+    std::span<InstBase* const> GetInputInsts() const
+    {
+        return { inputs_.data(), inputs_.size() };
+    }
+    // copy of the inputs with their source blocks
+    Inputs GetInputs() const;
     GETTER(Users, users_);
     GETTER(Id, id_);
     GETTER(Location, loc_);
+    // position in the basic block, valid only after BasicBlock::UpdateInstOrder
+    GETTER_SETTER(Order, uint32_t, order_);
+    // dense index in the last InstTable, built over the graph
+    GETTER_SETTER(TableIndex, uint32_t, table_idx_);
 
     InstBase* GetNext() const;
     void SetNext(std::unique_ptr<InstBase> next);
@@ -125,6 +149,10 @@ class InstBase : public marker::Markable
     void RemoveInput(const Input& input) noexcept;
     void AddInput(InstBase* inst, BasicBlock* bb);
     void AddInput(const Input& input);
+    // input of phi, incoming from bb
+    InstBase* GetPhiInput(const BasicBlock* bb) const;
+    // source blocks of phi inputs, parallel to GetInputInsts
+    std::span<BasicBlock* const> GetPhiSources() const;
 
     size_t GetNumUsers() const;
     void AddUser(InstBase* inst);
@@ -133,6 +161,8 @@ class InstBase : public marker::Markable
     void RemoveUser(const User& user);
     void RemoveUser(InstBase* user);
     void ReplaceUser(const User& user_old, const User& user_new);
+    // users of the instruction are redirected to inst
+    void ReplaceUsers(InstBase* inst);
 
     void SetLocation(Location::Where loc, unsigned slot);
 
@@ -154,6 +184,9 @@ class InstBase : public marker::Markable
     bool IsDynamic() const;
     bool IsPhi() const;
     bool IsConst() const;
+    bool IsIntegralConst() const;
+    // value of integral constant
+    int64_t GetIntegralConst() const;
     bool IsParam() const;
     bool IsCall() const;
     bool IsCheck() const;
@@ -174,13 +207,17 @@ class InstBase : public marker::Markable
         return true;
     }
 
-    virtual void Dump() const;
+    // calls DumpImpl of the concrete instruction type
+    void Dump() const;
+    void DumpImpl() const;
 
   protected:
     explicit InstBase(isa::inst::Opcode op) : id_(RecieveId()), opcode_(op)
     {
         inputs_.resize(GetNumInputs());
     }
+    // instructions are deleted only by their concrete type, see std::default_delete<InstBase>
+    DEFAULT_DTOR(InstBase);
 
     static IdType RecieveId()
     {
@@ -202,9 +239,11 @@ class InstBase : public marker::Markable
     isa::inst::Opcode opcode_;
     DataType data_type_{ DataType::VOID };
     BasicBlock* bb_{ nullptr };
+    uint32_t order_{ 0 };
+    uint32_t table_idx_{ 0 };
 
     std::list<User> users_{};
-    std::vector<Input> inputs_{};
+    SmallVector<InstBase*, isa::MAX_FIXED_INPUTS> inputs_{};
 
     Location loc_{};
 };
@@ -232,19 +271,32 @@ class Conditional
     Conditional(Type cond) : cond_{ cond }
     {
     }
-    virtual ~Conditional() = default;
+    DEFAULT_DTOR(Conditional);
     DEFAULT_CTOR(Conditional);
 
     GETTER_SETTER(Condition, Type, cond_);
 
     void Invert();
 
+    static Type Inverse(Type cond);
+    // a cond b holds iff b Swap(cond) a holds
+    static Type Swap(Type cond);
+    // value of lhs cond rhs for integers
+    static bool Evaluate(Type cond, int64_t lhs, int64_t rhs);
+    // if a fact b holds, returns value of a query b for the same a and b, nullopt if unknown
+    static std::optional<bool> Implies(Type fact, Type query);
+
     void Dump() const;
 
   private:
     Type cond_{ Type::UNSET };
 };
 
+// imm as an integer, nullopt if it is fractional or out of int64_t range
+std::optional<int64_t> ImmToIntegral(ImmType imm);
+// val as an immediate, nullopt if ImmType can't hold it exactly
+std::optional<ImmType> IntegralToImm(int64_t val);
+
 template <unsigned N>
 class WithImm
 {
@@ -252,7 +304,7 @@ class WithImm
     WithImm()
     {
     }
-    virtual ~WithImm() = default;
+    DEFAULT_DTOR(WithImm);
     GETTER(Imms, imms_);
 
     ImmType GetImm(unsigned idx) const
@@ -261,6 +313,12 @@ class WithImm
         return imms_[idx];
     }
 
+    // value of immediate idx, nullopt if it is not an integer
+    std::optional<int64_t> GetIntegralImm(unsigned idx) const
+    {
+        return ImmToIntegral(GetImm(idx));
+    }
+
     void SetImmediate(unsigned idx, ImmType imm)
     {
         ASSERT(idx < N);
@@ -363,9 +421,9 @@ class isa::inst_type::BIN_IMM
         ASSERT(ValueCond::value == IsConditional());
     }
 
-    void Dump() const override
+    void DumpImpl() const
     {
-        InstBase::Dump();
+        InstBase::DumpImpl();
         WithImm::Dump();
     }
 
@@ -391,6 +449,10 @@ class isa::inst_type::PHI : public InstBase
     }
 
   private:
+    friend class InstBase;
+
+    // source block of each input, kept parallel to inputs by InstBase
+    std::vector<BasicBlock*> sources_{};
 };
 
 class isa::inst_type::CALL : public InstBase
@@ -438,9 +500,9 @@ class isa::inst_type::IF : public InstBase, public Conditional
         ASSERT(ValueCond::value == IsConditional());
     }
 
-    void Dump() const override
+    void DumpImpl() const
     {
-        InstBase::Dump();
+        InstBase::DumpImpl();
         Conditional::Dump();
     }
 
@@ -468,9 +530,9 @@ class isa::inst_type::IF_IMM
         ASSERT(ValueCond::value == IsConditional());
     }
 
-    void Dump() const override
+    void DumpImpl() const
     {
-        InstBase::Dump();
+        InstBase::DumpImpl();
         WithImm::Dump();
         Conditional::Dump();
     }
@@ -497,9 +559,9 @@ class isa::inst_type::COMPARE : public InstBase, public Conditional
         ASSERT(ValueCond::value == IsConditional());
     }
 
-    void Dump() const override
+    void DumpImpl() const
     {
-        InstBase::Dump();
+        InstBase::DumpImpl();
         Conditional::Dump();
     }
 
@@ -553,7 +615,7 @@ class isa::inst_type::CONST : public InstBase
     double GetValDouble() const;
     float GetValFloat() const;
 
-    void Dump() const override;
+    void DumpImpl() const;
 
   private:
     uint64_t val_{ 0 };
@@ -563,7 +625,7 @@ template <isa::inst::Opcode OPCODE, typename... Args>
 std::unique_ptr<InstBase> InstBase::NewInst(Args&&... args)
 {
     using Type = typename isa::inst::Inst<OPCODE>::Type;
-    return std::unique_ptr<Type>(new Type(OPCODE, std::forward<Args>(args)...));
+    return std::unique_ptr<InstBase>(new Type(OPCODE, std::forward<Args>(args)...));
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef ___INST_FWD_H_INCLUDED___
+#define ___INST_FWD_H_INCLUDED___
+
+#include <memory>
+
+class InstBase;
+
+// instructions have no vtable, so std::unique_ptr<InstBase> deletes them by their concrete type,
+// which is selected by opcode. the specialization must be visible wherever instructions are owned
+template <>
+struct std::default_delete<InstBase>
+{
+    void operator()(InstBase* inst) const noexcept;
+};
+
+#endif
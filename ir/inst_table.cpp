@@ -0,0 +1,37 @@
+#include "inst_table.h"
+#include "bb.h"
+#include "graph.h"
+
+InstTable::InstTable(Graph* graph)
+{
+    ASSERT(graph != nullptr);
+
+    auto blocks = graph->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+    for (auto bb : blocks) {
+        for (auto phi = bb->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+            Append(phi);
+        }
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            Append(inst);
+        }
+    }
+
+    // inputs are resolved after numbering, because of phis and back edges
+    input_offsets_.reserve(Size() + 1);
+    input_offsets_.push_back(0);
+    for (auto inst : insts_) {
+        for (unsigned i = 0; i < inst->GetNumInputs(); ++i) {
+            inputs_.push_back(GetIndex(inst->GetInput(i).GetInst()));
+        }
+        input_offsets_.push_back(static_cast<Index>(inputs_.size()));
+    }
+}
+
+void InstTable::Append(InstBase* inst)
+{
+    inst->SetTableIndex(static_cast<Index>(Size()));
+    insts_.push_back(inst);
+    opcodes_.push_back(inst->GetOpcode());
+    data_types_.push_back(inst->GetDataType());
+    block_ids_.push_back(inst->GetBasicBlock()->GetId());
+}
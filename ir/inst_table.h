@@ -0,0 +1,92 @@
+#ifndef ___INST_TABLE_H_INCLUDED___
+#define ___INST_TABLE_H_INCLUDED___
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "inst.h"
+#include "typedefs.h"
+#include "utils/macros.h"
+
+class Graph;
+
+// compact structure-of-arrays snapshot of graph instructions for passes, that scan all of them.
+// instructions are numbered densely in RPO, phis of the block go before it's instructions, the
+// number is stored in the instruction itself. opcodes, types, blocks and inputs are stored in
+// contiguous arrays, inputs of an instruction are indices of other instructions. InstBase* is
+// kept only as a handle to modify the graph, so the table is not updated by graph modifications
+// and should be rebuilt after them
+class InstTable
+{
+  public:
+    using Index = uint32_t;
+
+    explicit InstTable(Graph* graph);
+    NO_COPY_SEMANTIC(InstTable);
+    NO_MOVE_SEMANTIC(InstTable);
+    DEFAULT_DTOR(InstTable);
+
+    size_t Size() const
+    {
+        return insts_.size();
+    }
+
+    InstBase* GetInst(Index idx) const
+    {
+        ASSERT(idx < Size());
+        return insts_[idx];
+    }
+
+    Index GetIndex(const InstBase* inst) const
+    {
+        ASSERT(inst != nullptr);
+        ASSERT(inst->GetTableIndex() < Size() && insts_[inst->GetTableIndex()] == inst);
+        return inst->GetTableIndex();
+    }
+
+    isa::inst::Opcode GetOpcode(Index idx) const
+    {
+        ASSERT(idx < Size());
+        return opcodes_[idx];
+    }
+
+    InstBase::DataType GetDataType(Index idx) const
+    {
+        ASSERT(idx < Size());
+        return data_types_[idx];
+    }
+
+    IdType GetBlockId(Index idx) const
+    {
+        ASSERT(idx < Size());
+        return block_ids_[idx];
+    }
+
+    std::span<const Index> GetInputs(Index idx) const
+    {
+        ASSERT(idx < Size());
+        return { inputs_.data() + input_offsets_[idx],
+                 inputs_.data() + input_offsets_[idx + 1] };
+    }
+
+    template <isa::flag::Type FLAG>
+    bool HasFlag(Index idx) const
+    {
+        return isa::EvaluatePredicate<InstBase::FlagPredicate<FLAG>::template Predicate>(
+            GetOpcode(idx));
+    }
+
+  private:
+    void Append(InstBase* inst);
+
+    std::vector<InstBase*> insts_{};
+    std::vector<isa::inst::Opcode> opcodes_{};
+    std::vector<InstBase::DataType> data_types_{};
+    std::vector<IdType> block_ids_{};
+    // inputs of instruction i are inputs_[input_offsets_[i] .. input_offsets_[i + 1])
+    std::vector<Index> input_offsets_{};
+    std::vector<Index> inputs_{};
+};
+
+#endif
@@ -67,6 +67,16 @@ bool Loop::Inside(const Loop* other) const
     return false;
 }
 
+bool Loop::Contains(const BasicBlock* bb) const
+{
+    ASSERT(bb != nullptr);
+    auto* loop = bb->GetLoop();
+    if (loop == nullptr) {
+        return false;
+    }
+    return loop == this || loop->Inside(this);
+}
+
 void Loop::Dump()
 {
     std::cout << "loop #" << id_ << "\n";
@@ -36,6 +36,8 @@ class Loop
     void ClearBackEdges();
 
     bool Inside(const Loop* other) const;
+    // true if bb belongs to this loop or to one of it's inner loops
+    bool Contains(const BasicBlock* bb) const;
 
     void Dump();
 
@@ -0,0 +1,46 @@
+#include "profile.h"
+
+void Profile::SetEdgeCount(IdType from, IdType to, uint64_t count)
+{
+    counts_[{ from, to }] = count;
+}
+
+uint64_t Profile::GetEdgeCount(IdType from, IdType to) const
+{
+    auto it = counts_.find({ from, to });
+    return (it == counts_.end()) ? 0 : it->second;
+}
+
+bool Profile::IsEmpty() const
+{
+    return counts_.empty();
+}
+
+void Profile::Clear()
+{
+    counts_.clear();
+}
+
+bool Profile::Load(std::istream& is)
+{
+    Clear();
+
+    IdType from{};
+    IdType to{};
+    uint64_t count{};
+    bool is_valid = true;
+    while (is_valid && is >> from) {
+        is_valid = static_cast<bool>(is >> to >> count);
+        if (is_valid) {
+            SetEdgeCount(from, to, count);
+        }
+    }
+
+    if (!is_valid || !is.eof()) {
+        LOG_ERROR("malformed edge profile");
+        Clear();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef ___PROFILE_H_INCLUDED___
+#define ___PROFILE_H_INCLUDED___
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <utility>
+
+#include "typedefs.h"
+#include "utils/macros.h"
+
+// execution counts of CFG edges, collected by an interpreter or loaded from a file. edges are
+// identified by ids of their blocks, counts of edges, that no longer exist, are never queried
+class Profile
+{
+  public:
+    DEFAULT_CTOR(Profile);
+    NO_COPY_SEMANTIC(Profile);
+    NO_MOVE_SEMANTIC(Profile);
+
+    void SetEdgeCount(IdType from, IdType to, uint64_t count);
+    // 0 if the edge was never executed or has no count
+    uint64_t GetEdgeCount(IdType from, IdType to) const;
+
+    bool IsEmpty() const;
+    void Clear();
+
+    // reads "from to count" triples separated by whitespace. on malformed input profile is
+    // left empty and false is returned
+    bool Load(std::istream& is);
+
+  private:
+    std::map<std::pair<IdType, IdType>, uint64_t> counts_{};
+};
+
+#endif
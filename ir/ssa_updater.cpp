@@ -0,0 +1,269 @@
+#include "ssa_updater.h"
+#include "bb.h"
+
+void SSAUpdater::AddDefinition(BasicBlock* bb, InstBase* value)
+{
+    ASSERT(bb != nullptr);
+    ASSERT(value != nullptr);
+    // values at entries depend on definitions
+    ASSERT(entry_values_.empty());
+
+    defs_[bb] = value;
+}
+
+bool SSAUpdater::HasDefinition(BasicBlock* bb) const
+{
+    return defs_.count(bb) != 0;
+}
+
+InstBase* SSAUpdater::GetValueAtEnd(BasicBlock* bb)
+{
+    ASSERT(bb != nullptr);
+
+    auto it = defs_.find(bb);
+    if (it != defs_.end()) {
+        return it->second;
+    }
+
+    return GetValueAtEntry(bb);
+}
+
+InstBase* SSAUpdater::GetValueAtEntry(BasicBlock* bb)
+{
+    ASSERT(bb != nullptr);
+
+    auto it = entry_values_.find(bb);
+    if (it != entry_values_.end()) {
+        return it->second;
+    }
+
+    // explicit stack instead of recursion, long chains of blocks would overflow the call stack
+    std::vector<Frame> stack{ Frame{ bb } };
+    while (!stack.empty()) {
+        auto& frame = stack.back();
+        auto cur = frame.bb;
+        const auto& preds = cur->GetPredecessors();
+
+        // value is not defined on some path
+        ASSERT(!preds.empty());
+
+        if (preds.size() > 1 && frame.phi == nullptr) {
+            // phi is registered before it's inputs are collected to break cycles
+            frame.phi = NewPhi(cur);
+            SetEntryValue(cur, frame.phi);
+            incomplete_phis_.insert(frame.phi);
+        }
+
+        InstBase* value = nullptr;
+        while (frame.next_pred < preds.size()) {
+            value = FindValueAtEnd(preds[frame.next_pred]);
+            if (value == nullptr) {
+                break;
+            }
+            if (frame.phi != nullptr) {
+                frame.phi->AddInput(value, preds[frame.next_pred]);
+            }
+            ++frame.next_pred;
+        }
+
+        if (value == nullptr) {
+            // frame is invalidated by push_back, predecessor is computed first
+            auto pred = preds[frame.next_pred];
+            stack.push_back(Frame{ pred });
+            continue;
+        }
+
+        auto phi = frame.phi;
+        stack.pop_back();
+
+        if (phi == nullptr) {
+            SetEntryValue(cur, value);
+        } else {
+            incomplete_phis_.erase(phi);
+            TryRemoveTrivialPhi(phi);
+        }
+    }
+
+    // replacement of phi may be removed as trivial as well, entries are redirected each time
+    return entry_values_.at(bb);
+}
+
+InstBase* SSAUpdater::GetValueForUse(InstBase* user, unsigned idx)
+{
+    ASSERT(user != nullptr);
+    ASSERT(idx < user->GetNumInputs());
+
+    if (user->IsPhi()) {
+        return GetValueAtEnd(user->GetInput(idx).GetSourceBB());
+    }
+
+    auto bb = user->GetBasicBlock();
+    auto it = defs_.find(bb);
+    if (it != defs_.end()) {
+        auto def = it->second;
+        if (def->GetBasicBlock() == bb && def != user && def->Precedes(user)) {
+            return def;
+        }
+    }
+
+    return GetValueAtEntry(bb);
+}
+
+void SSAUpdater::RewriteUses(InstBase* value)
+{
+    ASSERT(value != nullptr);
+
+    std::vector<InstBase*> users{};
+    std::unordered_set<InstBase*> visited{};
+    for (const auto& user : value->GetUsers()) {
+        auto inst = user.GetInst();
+        if (phis_.count(inst) == 0 && visited.insert(inst).second) {
+            users.push_back(inst);
+        }
+    }
+
+    for (auto user : users) {
+        // inputs are collected before users are rewired, since new phis may use value
+        std::vector<std::pair<unsigned, InstBase*> > new_inputs{};
+        for (unsigned i = 0; i < user->GetNumInputs(); ++i) {
+            if (user->GetInput(i).GetInst() == value) {
+                new_inputs.emplace_back(i, GetValueForUse(user, i));
+            }
+        }
+
+        value->RemoveUser(user);
+        for (const auto& [idx, new_input] : new_inputs) {
+            if (user->IsDynamic()) {
+                user->SetInput(idx, new_input, user->GetInput(idx).GetSourceBB());
+            } else {
+                user->SetInput(idx, new_input);
+            }
+        }
+    }
+}
+
+std::vector<InstBase*> SSAUpdater::GetInsertedPhis() const
+{
+    return std::vector<InstBase*>(phis_.begin(), phis_.end());
+}
+
+InstBase* SSAUpdater::FindValueAtEnd(BasicBlock* bb) const
+{
+    auto def = defs_.find(bb);
+    if (def != defs_.end()) {
+        return def->second;
+    }
+
+    auto entry = entry_values_.find(bb);
+    return (entry != entry_values_.end()) ? entry->second : nullptr;
+}
+
+void SSAUpdater::SetEntryValue(BasicBlock* bb, InstBase* value)
+{
+    entry_values_[bb] = value;
+    entry_blocks_[value].push_back(bb);
+}
+
+InstBase* SSAUpdater::NewPhi(BasicBlock* bb)
+{
+    auto phi = InstBase::NewInst<isa::inst::Opcode::PHI>();
+    phi->SetDataType(type_);
+
+    auto res = phi.get();
+    bb->PushBackPhi(std::move(phi));
+    phis_.insert(res);
+
+    return res;
+}
+
+// phi, which inputs are only itself and one other value, is replaced with that value. phis,
+// that used it, may become trivial as well, so the value may be freed after the call and only
+// entry_values_ should be used to get the replacement
+void SSAUpdater::TryRemoveTrivialPhi(InstBase* phi)
+{
+    std::vector<InstBase*> worklist{ phi };
+    while (!worklist.empty()) {
+        auto cur = worklist.back();
+        worklist.pop_back();
+
+        // phi may be removed by the previous iterations, so it is looked up before access
+        if (phis_.count(cur) == 0 || incomplete_phis_.count(cur) != 0) {
+            continue;
+        }
+
+        InstBase* same{ nullptr };
+        bool is_trivial = true;
+        for (auto value : cur->GetInputInsts()) {
+            if (value == same || value == cur) {
+                continue;
+            }
+            if (same != nullptr) {
+                is_trivial = false;
+                break;
+            }
+            same = value;
+        }
+
+        if (!is_trivial) {
+            continue;
+        }
+
+        // phi is unreachable or references only itself
+        ASSERT(same != nullptr);
+
+        for (const auto& user : cur->GetUsers()) {
+            auto inst = user.GetInst();
+            if (inst != cur && phis_.count(inst) != 0) {
+                worklist.push_back(inst);
+            }
+        }
+
+        RemovePhi(cur, same);
+    }
+}
+
+void SSAUpdater::RemovePhi(InstBase* phi, InstBase* same)
+{
+    std::vector<InstBase*> phi_users{};
+    std::unordered_set<InstBase*> visited{};
+    for (const auto& user : phi->GetUsers()) {
+        auto inst = user.GetInst();
+        if (inst != phi && visited.insert(inst).second) {
+            phi_users.push_back(inst);
+        }
+    }
+
+    for (auto user : phi_users) {
+        for (unsigned i = 0; i < user->GetNumInputs(); ++i) {
+            if (user->GetInput(i).GetInst() != phi) {
+                continue;
+            }
+            if (user->IsDynamic()) {
+                same->AddUser(user);
+            } else {
+                same->AddUser(user, i);
+            }
+        }
+        user->ReplaceInput(phi, same);
+    }
+
+    for (auto input : phi->GetInputInsts()) {
+        input->RemoveUser(phi);
+    }
+
+    auto it = entry_blocks_.find(phi);
+    if (it != entry_blocks_.end()) {
+        auto blocks = std::move(it->second);
+        entry_blocks_.erase(it);
+        for (auto bb : blocks) {
+            auto& value = entry_values_.at(bb);
+            if (value == phi) {
+                value = same;
+                entry_blocks_[same].push_back(bb);
+            }
+        }
+    }
+
+    phis_.erase(phi);
+    phi->GetBasicBlock()->UnlinkInst(phi);
+}
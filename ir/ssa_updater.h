@@ -0,0 +1,72 @@
+#ifndef ___SSA_UPDATER_H_INCLUDED___
+#define ___SSA_UPDATER_H_INCLUDED___
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "inst.h"
+#include "utils/macros.h"
+
+class BasicBlock;
+
+// rewires uses of a value, that has several reaching definitions, inserting minimal number of
+// phis. phis are created on demand and trivial ones are removed right away, as in
+// Braun et al. "Simple and Efficient Construction of Static Single Assignment Form".
+//
+// CFG should be complete: all predecessors of blocks, where value is requested, are known, and
+// every path from the start block to a use passes through a definition
+class SSAUpdater
+{
+  public:
+    explicit SSAUpdater(InstBase::DataType type) : type_{ type }
+    {
+    }
+
+    NO_COPY_SEMANTIC(SSAUpdater);
+    NO_MOVE_SEMANTIC(SSAUpdater);
+
+    // value is available at the end of bb. value defined in bb also reaches instructions of bb
+    // after it
+    void AddDefinition(BasicBlock* bb, InstBase* value);
+    bool HasDefinition(BasicBlock* bb) const;
+
+    InstBase* GetValueAtEnd(BasicBlock* bb);
+    InstBase* GetValueAtEntry(BasicBlock* bb);
+    // value, that reaches idx'th input of user
+    InstBase* GetValueForUse(InstBase* user, unsigned idx);
+
+    // every use of value is replaced with the definition, that reaches it
+    void RewriteUses(InstBase* value);
+
+    // phis, that were inserted and were not removed as trivial, in no particular order
+    std::vector<InstBase*> GetInsertedPhis() const;
+
+  private:
+    // block, which entry value is being computed. phi is set once it's inputs are collected
+    struct Frame
+    {
+        BasicBlock* bb{ nullptr };
+        InstBase* phi{ nullptr };
+        size_t next_pred{ 0 };
+    };
+
+    // nullptr if value at the end of bb is not computed yet
+    InstBase* FindValueAtEnd(BasicBlock* bb) const;
+    void SetEntryValue(BasicBlock* bb, InstBase* value);
+    InstBase* NewPhi(BasicBlock* bb);
+    void TryRemoveTrivialPhi(InstBase* phi);
+    void RemovePhi(InstBase* phi, InstBase* same);
+
+    InstBase::DataType type_;
+
+    std::unordered_map<BasicBlock*, InstBase*> defs_{};
+    std::unordered_map<BasicBlock*, InstBase*> entry_values_{};
+    // blocks, which entry value is the key. may contain stale blocks, that were redirected
+    std::unordered_map<InstBase*, std::vector<BasicBlock*> > entry_blocks_{};
+    std::unordered_set<InstBase*> phis_{};
+    // phis, which inputs are being collected, can't be considered trivial yet
+    std::unordered_set<InstBase*> incomplete_phis_{};
+};
+
+#endif
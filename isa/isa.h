@@ -8,6 +8,7 @@
 #include "instruction.h"
 #include "isa_def.h"
 
+#include <algorithm>
 #include <array>
 
 namespace isa {
@@ -40,6 +41,12 @@ struct InputValue
     static constexpr decltype(Res::value) value = Res::value;
 };
 
+// the largest number of vreg inputs among instruction types with fixed number of inputs
+#define GEN_NUM_VREG_INPUTS(INST_TYPE, ...) InputValue<inst_type::INST_TYPE, input::Type::VREG>::value,
+inline constexpr auto MAX_FIXED_INPUTS =
+    std::max({ ISA_INSTRUCTION_TYPE_LIST(GEN_NUM_VREG_INPUTS) });
+#undef GEN_NUM_VREG_INPUTS
+
 template <inst::Opcode OPCODE, flag::Type F>
 using HasFlag = type_sequence::find<typename inst::Inst<OPCODE>::Flags, flag::Flag<F> >;
 
@@ -0,0 +1,226 @@
+#include "block_frequency.h"
+#include "ir/bb.h"
+#include "ir/graph.h"
+#include "ir/loop.h"
+
+#include <algorithm>
+
+using BranchFlag = isa::flag::Flag<isa::flag::Type::BRANCH>;
+
+// probability of the event, predicted by two independent heuristics
+static double Combine(double p, double q)
+{
+    auto d = p * q + (1.0 - p) * (1.0 - q);
+    return (d > 0.0) ? (p * q / d) : 0.5;
+}
+
+static bool IsBackEdge(BasicBlock* bb, BasicBlock* succ)
+{
+    return succ->IsLoopHeader() && succ->GetLoop()->Contains(bb);
+}
+
+static bool IsLoopExit(BasicBlock* bb, BasicBlock* succ)
+{
+    auto loop = bb->GetLoop();
+    return loop != nullptr && !loop->IsRoot() && !loop->Contains(succ);
+}
+
+static bool IsLoopEntry(BasicBlock* bb, BasicBlock* succ)
+{
+    return succ->IsLoopHeader() && !succ->GetLoop()->Contains(bb);
+}
+
+static bool IsReturn(BasicBlock* bb)
+{
+    return bb->GetNumSuccessors() == BranchFlag::Value::NO_SUCCESSORS;
+}
+
+// bb checks value for zero or null, so it always fails, if entered on value == 0
+static bool ChecksValue(BasicBlock* bb, InstBase* value)
+{
+    for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        auto opcode = inst->GetOpcode();
+        if ((opcode == isa::inst::Opcode::CHECK_ZERO || opcode == isa::inst::Opcode::CHECK_NULL) &&
+            inst->GetInput(0).GetInst() == value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BlockFrequency::Run()
+{
+    ResetState();
+
+    auto pm = graph_->GetPassManager();
+    pm->GetValidPass<DomTree>();
+    auto root = pm->GetValidPass<LoopAnalysis>()->GetRootLoop();
+    // predecessors should be visited first, so order is built from post order
+    auto po = pm->GetValidPass<PO>()->GetBlocks();
+    rpo_.assign(po.rbegin(), po.rend());
+
+    auto use_profile = !graph_->GetProfile()->IsEmpty();
+    for (auto bb : rpo_) {
+        if (bb->GetNumSuccessors() != BranchFlag::Value::TWO_SUCCESSORS) {
+            continue;
+        }
+
+        auto prob = use_profile ? GetProfileProbability(bb) : -1.0;
+        true_probs_[bb] = (prob < 0.0) ? EstimateProbability(bb) : prob;
+    }
+
+    PropagateLoop(root);
+    Propagate(graph_->GetStartBasicBlock(), nullptr);
+
+    SetValid(true);
+
+    return true;
+}
+
+double BlockFrequency::GetProbability(BasicBlock* bb, BasicBlock* succ) const
+{
+    ASSERT(bb != nullptr);
+    ASSERT(succ != nullptr);
+
+    auto it = true_probs_.find(bb);
+    if (it == true_probs_.end()) {
+        return bb->Precedes(succ) ? 1.0 : 0.0;
+    }
+
+    if (bb->GetSuccessor(Conditional::Branch::BRANCH_TRUE) == succ) {
+        return it->second;
+    }
+    return bb->Precedes(succ) ? (1.0 - it->second) : 0.0;
+}
+
+double BlockFrequency::GetFrequency(BasicBlock* bb) const
+{
+    ASSERT(bb != nullptr);
+
+    auto it = frequencies_.find(bb);
+    return (it == frequencies_.end()) ? 0.0 : it->second;
+}
+
+double BlockFrequency::GetEdgeFrequency(BasicBlock* bb, BasicBlock* succ) const
+{
+    return GetFrequency(bb) * GetProbability(bb, succ);
+}
+
+// negative, if the profile has no counts for the branch
+double BlockFrequency::GetProfileProbability(BasicBlock* bb) const
+{
+    auto profile = graph_->GetProfile();
+    auto succ_true = bb->GetSuccessor(Conditional::Branch::BRANCH_TRUE);
+    auto succ_false = bb->GetSuccessor(Conditional::Branch::FALLTHROUGH);
+
+    auto count_true = profile->GetEdgeCount(bb->GetId(), succ_true->GetId());
+    auto count_false = profile->GetEdgeCount(bb->GetId(), succ_false->GetId());
+    if (count_true + count_false == 0) {
+        return -1.0;
+    }
+
+    return static_cast<double>(count_true) / static_cast<double>(count_true + count_false);
+}
+
+double BlockFrequency::EstimateProbability(BasicBlock* bb) const
+{
+    auto succ_true = bb->GetSuccessor(Conditional::Branch::BRANCH_TRUE);
+    auto succ_false = bb->GetSuccessor(Conditional::Branch::FALLTHROUGH);
+    double prob = 0.5;
+
+    // heuristic applies, if it matches exactly one successor
+    auto apply = [&prob, succ_true, succ_false](auto matches, double edge_prob) {
+        bool matches_true = matches(succ_true);
+        bool matches_false = matches(succ_false);
+        if (matches_true != matches_false) {
+            prob = Combine(prob, matches_true ? edge_prob : (1.0 - edge_prob));
+        }
+    };
+
+    apply([bb](BasicBlock* succ) { return IsLoopExit(bb, succ); }, LOOP_EXIT_PROBABILITY);
+    apply([bb](BasicBlock* succ) { return IsBackEdge(bb, succ); }, 1.0 - LOOP_EXIT_PROBABILITY);
+    apply([bb](BasicBlock* succ) { return IsLoopEntry(bb, succ); }, LOOP_ENTRY_PROBABILITY);
+    apply([](BasicBlock* succ) { return IsReturn(succ); }, RETURN_PROBABILITY);
+
+    auto branch = bb->GetLastInst();
+    if (branch->GetOpcode() != isa::inst::Opcode::IF_IMM) {
+        return prob;
+    }
+
+    using IfImmT = isa::inst::Inst<isa::inst::Opcode::IF_IMM>::Type;
+    auto if_imm = static_cast<IfImmT*>(branch);
+    auto cond = if_imm->GetCondition();
+    auto imm = if_imm->GetIntegralImm(0);
+    if (!imm.has_value() || *imm != 0 ||
+        (cond != Conditional::Type::EQ && cond != Conditional::Type::NEQ)) {
+        return prob;
+    }
+
+    // successor, entered if value is zero
+    auto succ_zero = (cond == Conditional::Type::EQ) ? succ_true : succ_false;
+    auto value = branch->GetInput(0).GetInst();
+    apply([succ_zero](BasicBlock* succ) { return succ == succ_zero; },
+          ZERO_COMPARISON_PROBABILITY);
+    apply([succ_zero, value](BasicBlock* succ) {
+              return succ == succ_zero && succ->GetNumPredecessors() == 1 &&
+                     ChecksValue(succ, value);
+          },
+          CHECK_FAILURE_PROBABILITY);
+
+    return prob;
+}
+
+void BlockFrequency::PropagateLoop(Loop* loop)
+{
+    for (auto inner : loop->GetInnerLoops()) {
+        PropagateLoop(inner);
+    }
+
+    if (!loop->IsRoot()) {
+        Propagate(loop->GetHeader(), loop);
+    }
+}
+
+void BlockFrequency::Propagate(BasicBlock* head, Loop* loop)
+{
+    for (auto bb : rpo_) {
+        if (loop != nullptr && !loop->Contains(bb)) {
+            continue;
+        }
+
+        double freq = (bb == head) ? 1.0 : 0.0;
+        if (bb != head) {
+            for (auto pred : bb->GetPredecessors()) {
+                if (IsBackEdge(pred, bb) || (loop != nullptr && !loop->Contains(pred))) {
+                    continue;
+                }
+                freq += GetEdgeFrequency(pred, bb);
+            }
+
+            // inner loops are already processed
+            if (bb->IsLoopHeader()) {
+                freq /= 1.0 - cyclic_probs_[bb];
+            }
+        }
+
+        frequencies_[bb] = freq;
+    }
+
+    if (loop == nullptr) {
+        return;
+    }
+
+    double cyclic = 0.0;
+    for (auto latch : loop->GetBackEdges()) {
+        cyclic += GetEdgeFrequency(latch, head);
+    }
+    cyclic_probs_[head] = std::min(cyclic, 1.0 - 1.0 / MAX_LOOP_SCALE);
+}
+
+void BlockFrequency::ResetState()
+{
+    rpo_.clear();
+    true_probs_.clear();
+    frequencies_.clear();
+    cyclic_probs_.clear();
+}
@@ -0,0 +1,67 @@
+#ifndef __PASS_BLOCK_FREQUENCY_INCLUDED__
+#define __PASS_BLOCK_FREQUENCY_INCLUDED__
+
+#include <unordered_map>
+#include <vector>
+
+#include "pass.h"
+
+class BasicBlock;
+class Loop;
+
+// estimates probabilities of CFG edges and execution frequencies of blocks per one execution of
+// the start block. if the graph has edge profile, branches are weighted by it's counts,
+// otherwise by static heuristics (Ball, Larus "Branch prediction for free"):
+// - loop branch: edge, that leaves the loop, is unlikely, back edge is likely
+// - loop header: edge, that enters a loop, is likely
+// - return: edge to a block, that returns, is unlikely
+// - zero comparison: IF_IMM x, 0, EQ is unlikely to be taken
+// - check: edge, after which CHECK_ZERO / CHECK_NULL of the compared value fails, is cold
+// heuristics are combined as in Wu, Larus "Static branch frequency and program profile
+// analysis". checks are assumed to never fail, so they don't affect frequencies otherwise.
+//
+// frequencies are propagated from inner loops to outer ones, loop header frequency is scaled
+// by 1 / (1 - probability to return to the header), but not more than by MAX_LOOP_SCALE
+class BlockFrequency : public Pass
+{
+  public:
+    using is_cfg_sensitive = std::true_type;
+
+    // probabilities of the edge, matching the heuristic
+    static constexpr double LOOP_EXIT_PROBABILITY = 0.12;
+    static constexpr double LOOP_ENTRY_PROBABILITY = 0.75;
+    static constexpr double RETURN_PROBABILITY = 0.28;
+    static constexpr double ZERO_COMPARISON_PROBABILITY = 0.4;
+    static constexpr double CHECK_FAILURE_PROBABILITY = 0.01;
+    static constexpr double MAX_LOOP_SCALE = 1024.0;
+
+    BlockFrequency(Graph* graph) : Pass(graph)
+    {
+    }
+
+    bool Run() override;
+
+    // probability, that control goes from bb to succ
+    double GetProbability(BasicBlock* bb, BasicBlock* succ) const;
+    // 0 for unreachable blocks
+    double GetFrequency(BasicBlock* bb) const;
+    double GetEdgeFrequency(BasicBlock* bb, BasicBlock* succ) const;
+
+  private:
+    // probability of the BRANCH_TRUE successor of two-way branch
+    double GetProfileProbability(BasicBlock* bb) const;
+    double EstimateProbability(BasicBlock* bb) const;
+
+    void PropagateLoop(Loop* loop);
+    // loop is nullptr for the whole graph
+    void Propagate(BasicBlock* head, Loop* loop);
+    void ResetState();
+
+    std::vector<BasicBlock*> rpo_{};
+    std::unordered_map<BasicBlock*, double> true_probs_{};
+    std::unordered_map<BasicBlock*, double> frequencies_{};
+    // probability to return to the loop header per it's execution
+    std::unordered_map<BasicBlock*, double> cyclic_probs_{};
+};
+
+#endif
@@ -2,9 +2,9 @@
 #include "dom_tree.h"
 #include "ir/bb.h"
 #include "ir/graph.h"
-#include "loop_analysis.h"
 
-GEN_DEFAULT_VISIT_FUNCTIONS(CheckElimination, RPO);
+#include <cmath>
+#include <functional>
 
 static void DeleteCheck(InstBase* check)
 {
@@ -13,193 +13,291 @@ static void DeleteCheck(InstBase* check)
     ASSERT(check->GetNumUsers() == 0);
     ASSERT(check->GetBasicBlock() != nullptr);
 
-    for (auto i : check->GetInputs()) {
-        ASSERT(i.GetInst() != nullptr);
-        i.GetInst()->RemoveUser(check);
+    for (auto input : check->GetInputInsts()) {
+        ASSERT(input != nullptr);
+        input->RemoveUser(check);
     }
     check->GetBasicBlock()->UnlinkInst(check);
 }
 
-// returns true if two checks with same check subject are equivalent
-using EquivalenceCriterion = bool (*)(const InstBase*, const InstBase*);
+template <isa::inst::Opcode OPCODE>
+static bool CheckRedundancy(InstBase* check);
 
-template <isa::inst::Opcode OPCODE, typename EquivalenceCriterion>
-static void DeleteDominatedChecks(InstBase* inst, EquivalenceCriterion eq_criterion)
+template <>
+bool CheckRedundancy<isa::inst::Opcode::CHECK_ZERO>(InstBase* check)
 {
-    ASSERT(inst != nullptr);
-    ASSERT(inst->IsCheck());
-    ASSERT(inst->GetNumUsers() == 0);
-    ASSERT(inst->GetNumInputs() != 0);
-    ASSERT(inst->GetInput(0).GetInst() != nullptr);
+    using T = typename isa::inst::Inst<isa::inst::Opcode::CHECK_ZERO>::Type;
+    STATIC_ASSERT(!isa::InputValue<T, isa::input::Type::DYN>::value);
+    STATIC_ASSERT(isa::HasFlag<isa::inst::Opcode::CHECK_ZERO, isa::flag::Type::CHECK>::value);
+    STATIC_ASSERT(isa::InputValue<T, isa::input::Type::VREG>::value != 0);
+    ASSERT(check->GetOpcode() == isa::inst::Opcode::CHECK_ZERO);
 
-    auto check_input = inst->GetInput(0).GetInst();
+    auto input = check->GetInput(0).GetInst();
+    ASSERT(input != nullptr);
 
-    for (const auto user : check_input->GetUsers()) {
-        ASSERT(user.GetInst() != nullptr);
-        auto user_inst = user.GetInst();
+    using ConstT = typename isa::inst::Inst<isa::inst::Opcode::CONST>::Type;
+    if (input->IsConst() && !static_cast<ConstT*>(input)->IsZero()) {
+        return true;
+    }
 
-        if (user_inst->GetOpcode() != OPCODE) {
-            continue;
-        }
+    return false;
+}
 
-        if (user_inst->GetId() == inst->GetId()) {
-            continue;
-        }
+template <>
+bool CheckRedundancy<isa::inst::Opcode::CHECK_NULL>(InstBase* check)
+{
+    using T = typename isa::inst::Inst<isa::inst::Opcode::CHECK_NULL>::Type;
+    STATIC_ASSERT(!isa::InputValue<T, isa::input::Type::DYN>::value);
+    STATIC_ASSERT(isa::InputValue<T, isa::input::Type::VREG>::value != 0);
+    STATIC_ASSERT(isa::HasFlag<isa::inst::Opcode::CHECK_NULL, isa::flag::Type::CHECK>::value);
+    ASSERT(check->GetOpcode() == isa::inst::Opcode::CHECK_NULL);
 
-        ASSERT(inst->GetBasicBlock() != nullptr);
-        ASSERT(user_inst->GetBasicBlock() != nullptr);
-        // since we are processing instructions in descending order in basic block, we can omit
-        // checking dominance for two instructions in the same block
-        bool in_same_block = inst->GetBasicBlock()->GetId() == user_inst->GetBasicBlock()->GetId();
-        bool dominates = in_same_block || inst->Dominates(user_inst);
+    auto input = check->GetInput(0).GetInst();
+    ASSERT(input != nullptr);
 
-        if (dominates && eq_criterion(user_inst, inst)) {
-            DeleteCheck(user_inst);
-        }
+    using ConstT = typename isa::inst::Inst<isa::inst::Opcode::CONST>::Type;
+    if (input->IsConst() && !static_cast<ConstT*>(input)->IsNull()) {
+        return true;
     }
-}
 
-template <isa::inst::Opcode OPCODE>
-static bool CheckRedundancy(InstBase* check);
+    return false;
+}
 
 bool CheckElimination::Run()
 {
     graph_->GetPassManager()->GetValidPass<DomTree>();
-    graph_->GetPassManager()->GetValidPass<LoopAnalysis>();
 
-    VisitGraph();
+    ResetStructs();
+    BuildDomTree();
+    VisitBlock(graph_->GetStartBasicBlock());
     RemoveRedundantChecks();
     ResetStructs();
 
     return true;
 }
 
-void CheckElimination::RemoveRedundantChecks()
+size_t CheckElimination::CheckKey::Hash::operator()(const CheckKey& key) const
 {
-    for (const auto i : redundant_checks_) {
-        DeleteCheck(i);
-    }
+    // boost::hash_combine
+    size_t res = 0;
+    auto combine = [&res](size_t val) { res ^= val + 0x9e3779b9 + (res << 6) + (res >> 2); };
+    combine(std::hash<unsigned>{}(key.opcode));
+    combine(std::hash<IdType>{}(key.subject));
+    combine(std::hash<bool>{}(key.arg_is_const));
+    combine(std::hash<unsigned>{}(static_cast<unsigned>(key.arg_type)));
+    combine(std::hash<uint64_t>{}(key.arg));
+    return res;
 }
 
-void CheckElimination::ResetStructs()
+// checks with the same key are equivalent
+CheckElimination::CheckKey CheckElimination::GetCheckKey(const InstBase* check)
 {
-    redundant_checks_.clear();
-}
+    ASSERT(check != nullptr);
+    ASSERT(check->IsCheck());
+    ASSERT(check->GetNumInputs() != 0);
+    ASSERT(check->GetNumInputs() <= 2);
 
-static bool AreSameOrSameVal(const InstBase* i1, const InstBase* i2)
-{
-    if (i1->GetId() == i2->GetId()) {
-        return true;
+    CheckKey key{};
+    key.opcode = check->GetOpcode();
+    key.subject = check->GetInput(0).GetInst()->GetId();
+
+    if (check->GetNumInputs() == 1) {
+        return key;
     }
 
-    if (i1->IsConst() && i2->IsConst()) {
-        return isa::inst::Inst<isa::inst::Opcode::CONST>::Type::Compare(i1, i2);
+    auto arg = check->GetInput(1).GetInst();
+    if (arg->IsConst()) {
+        using ConstT = isa::inst::Inst<isa::inst::Opcode::CONST>::Type;
+        key.arg_is_const = true;
+        key.arg_type = arg->GetDataType();
+        key.arg = static_cast<const ConstT*>(arg)->GetValRaw();
+    } else {
+        key.arg = arg->GetId();
     }
 
-    return false;
+    return key;
 }
 
-template <isa::inst::Opcode OPCODE>
-static bool DefaultEquivalenceCheck(const InstBase* i1, const InstBase* i2)
+void CheckElimination::BuildDomTree()
 {
-    using T = typename isa::inst::Inst<OPCODE>::Type;
-    using NumInputs = isa::InputValue<T, isa::input::Type::VREG>;
+    for (auto bb : graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        auto dom = bb->GetImmDominator();
+        if (dom != nullptr) {
+            dom_children_[dom].push_back(bb);
+        }
+    }
+}
 
-    STATIC_ASSERT(!isa::InputValue<T, isa::input::Type::DYN>::value);
-    STATIC_ASSERT(isa::HasFlag<OPCODE, isa::flag::Type::CHECK>::value);
-    ASSERT(i1->GetOpcode() == OPCODE);
-    ASSERT(i2->GetOpcode() == OPCODE);
-    ASSERT(i1->IsCheck());
-    ASSERT(i2->IsCheck());
-    STATIC_ASSERT(NumInputs::value != 0);
-    ASSERT(i1->GetNumInputs() == NumInputs::value);
-    ASSERT(i2->GetNumInputs() == NumInputs::value);
-    ASSERT(i1->GetNumInputs() == i2->GetNumInputs());
-    ASSERT(i1->GetId() != i2->GetId());
-    ASSERT(i1->GetInput(0).GetInst()->GetId() == i2->GetInput(0).GetInst()->GetId());
-
-    // if check only accepts object to check
-    if constexpr (NumInputs::value == 1) {
-        return true;
+void CheckElimination::VisitBlock(BasicBlock* bb)
+{
+    auto scope = scope_log_.size();
+
+    AddImpliedChecks(bb);
+
+    for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        if (inst->IsCheck()) {
+            VisitCheck(inst);
+        }
     }
 
-    for (unsigned i = 1; i < i1->GetNumInputs(); ++i) {
-        auto in1 = i1->GetInput(i).GetInst();
-        auto in2 = i2->GetInput(i).GetInst();
-        if (!AreSameOrSameVal(in1, in2)) {
-            return false;
+    if (dom_children_.count(bb) != 0) {
+        for (auto child : dom_children_.at(bb)) {
+            VisitBlock(child);
         }
     }
 
-    return true;
+    while (scope_log_.size() != scope) {
+        available_.erase(scope_log_.back());
+        scope_log_.pop_back();
+    }
 }
 
-template <>
-bool CheckRedundancy<isa::inst::Opcode::CHECK_ZERO>(InstBase* check)
+// constant, equal to zero by value of it's type, so -0.0 is zero too
+static bool IsZeroConst(const InstBase* inst)
 {
-    using T = typename isa::inst::Inst<isa::inst::Opcode::CHECK_ZERO>::Type;
-    STATIC_ASSERT(!isa::InputValue<T, isa::input::Type::DYN>::value);
-    STATIC_ASSERT(isa::HasFlag<isa::inst::Opcode::CHECK_ZERO, isa::flag::Type::CHECK>::value);
-    STATIC_ASSERT(isa::InputValue<T, isa::input::Type::VREG>::value != 0);
-    ASSERT(check->GetOpcode() == isa::inst::Opcode::CHECK_ZERO);
-
-    auto input = check->GetInput(0).GetInst();
-    ASSERT(input != nullptr);
-
-    using ConstT = typename isa::inst::Inst<isa::inst::Opcode::CONST>::Type;
-    if (input->IsConst() && !static_cast<ConstT*>(input)->IsZero()) {
-        return true;
+    if (!inst->IsConst()) {
+        return false;
     }
 
-    return false;
+    using ConstT = isa::inst::Inst<isa::inst::Opcode::CONST>::Type;
+    auto value = static_cast<const ConstT*>(inst);
+    switch (inst->GetDataType()) {
+    case InstBase::DataType::INT:
+        return value->GetValInt() == 0;
+    case InstBase::DataType::FLOAT:
+        return std::fpclassify(value->GetValFloat()) == FP_ZERO;
+    case InstBase::DataType::DOUBLE:
+        return std::fpclassify(value->GetValDouble()) == FP_ZERO;
+    default:
+        return false;
+    }
 }
 
-void CheckElimination::VisitCHECK_ZERO(GraphVisitor* v, InstBase* inst)
+static bool IsNonZeroIntegralConst(const InstBase* inst)
 {
-    DeleteDominatedChecks<isa::inst::Opcode::CHECK_ZERO>(
-        inst, DefaultEquivalenceCheck<isa::inst::Opcode::CHECK_ZERO>);
+    return inst->IsIntegralConst() && inst->GetIntegralConst() != 0;
+}
 
-    if (CheckRedundancy<isa::inst::Opcode::CHECK_ZERO>(inst)) {
-        static_cast<CheckElimination*>(v)->redundant_checks_.push_back(inst);
+// if value cond other holds, returns true if value is not zero. equality is used for integers
+// only, other_is_non_zero is set for non-zero integral constants
+static bool ImpliesNonZero(Conditional::Type cond, bool other_is_zero, bool other_is_non_zero)
+{
+    if (other_is_zero) {
+        // set of conditions is closed under swapping of operands
+        return cond == Conditional::Type::NEQ || cond == Conditional::Type::L ||
+               cond == Conditional::Type::G;
     }
+
+    return cond == Conditional::Type::EQ && other_is_non_zero;
 }
 
-template <>
-bool CheckRedundancy<isa::inst::Opcode::CHECK_NULL>(InstBase* check)
+// block, that is reached only through one edge of a branch, is dominated by the branch
+// condition (or by it's negation)
+void CheckElimination::AddImpliedChecks(BasicBlock* bb)
 {
-    using T = typename isa::inst::Inst<isa::inst::Opcode::CHECK_NULL>::Type;
-    STATIC_ASSERT(!isa::InputValue<T, isa::input::Type::DYN>::value);
-    STATIC_ASSERT(isa::InputValue<T, isa::input::Type::VREG>::value != 0);
-    STATIC_ASSERT(isa::HasFlag<isa::inst::Opcode::CHECK_NULL, isa::flag::Type::CHECK>::value);
-    ASSERT(check->GetOpcode() == isa::inst::Opcode::CHECK_NULL);
+    if (bb->GetNumPredecessors() != 1) {
+        return;
+    }
 
-    auto input = check->GetInput(0).GetInst();
-    ASSERT(input != nullptr);
+    auto pred = bb->GetPredecessor(0);
+    auto branch = pred->GetLastInst();
+    if (branch == nullptr || pred->GetNumSuccessors() != 2) {
+        return;
+    }
 
-    using ConstT = typename isa::inst::Inst<isa::inst::Opcode::CONST>::Type;
-    if (input->IsConst() && !static_cast<ConstT*>(input)->IsNull()) {
-        return true;
+    auto on_true = pred->GetSuccessor(Conditional::Branch::BRANCH_TRUE) == bb;
+    auto on_false = pred->GetSuccessor(Conditional::Branch::FALLTHROUGH) == bb;
+    if (on_true == on_false) {
+        return;
     }
 
-    return false;
+    std::vector<InstBase*> non_zero{};
+
+    if (branch->GetOpcode() == isa::inst::Opcode::IF_IMM) {
+        using IfImmT = isa::inst::Inst<isa::inst::Opcode::IF_IMM>::Type;
+        auto if_imm = static_cast<IfImmT*>(branch);
+        auto cond =
+            on_true ? if_imm->GetCondition() : Conditional::Inverse(if_imm->GetCondition());
+        auto imm = if_imm->GetIntegralImm(0);
+        auto is_zero = std::fpclassify(if_imm->GetImm(0)) == FP_ZERO;
+
+        if (ImpliesNonZero(cond, is_zero, imm.has_value() && *imm != 0)) {
+            non_zero.push_back(branch->GetInput(0).GetInst());
+        }
+    } else if (branch->GetOpcode() == isa::inst::Opcode::IF) {
+        using IfT = isa::inst::Inst<isa::inst::Opcode::IF>::Type;
+        auto cond_if = static_cast<IfT*>(branch);
+        auto cond =
+            on_true ? cond_if->GetCondition() : Conditional::Inverse(cond_if->GetCondition());
+        auto lhs = branch->GetInput(0).GetInst();
+        auto rhs = branch->GetInput(1).GetInst();
+
+        if (ImpliesNonZero(cond, IsZeroConst(rhs), IsNonZeroIntegralConst(rhs))) {
+            non_zero.push_back(lhs);
+        }
+        if (ImpliesNonZero(cond, IsZeroConst(lhs), IsNonZeroIntegralConst(lhs))) {
+            non_zero.push_back(rhs);
+        }
+    }
+
+    for (auto value : non_zero) {
+        for (auto opcode : { isa::inst::Opcode::CHECK_ZERO, isa::inst::Opcode::CHECK_NULL }) {
+            CheckKey key{};
+            key.opcode = opcode;
+            key.subject = value->GetId();
+            MakeAvailable(key);
+        }
+    }
 }
 
-void CheckElimination::VisitCHECK_NULL(GraphVisitor* v, InstBase* inst)
+void CheckElimination::VisitCheck(InstBase* check)
 {
-    DeleteDominatedChecks<isa::inst::Opcode::CHECK_NULL>(
-        inst, DefaultEquivalenceCheck<isa::inst::Opcode::CHECK_NULL>);
+    auto key = GetCheckKey(check);
+
+    if (available_.count(key) != 0) {
+        redundant_checks_.push_back(check);
+        return;
+    }
 
-    if (CheckRedundancy<isa::inst::Opcode::CHECK_NULL>(inst)) {
-        static_cast<CheckElimination*>(v)->redundant_checks_.push_back(inst);
+    switch (check->GetOpcode()) {
+    case isa::inst::Opcode::CHECK_ZERO:
+        if (CheckRedundancy<isa::inst::Opcode::CHECK_ZERO>(check)) {
+            redundant_checks_.push_back(check);
+            return;
+        }
+        break;
+    case isa::inst::Opcode::CHECK_NULL:
+        if (CheckRedundancy<isa::inst::Opcode::CHECK_NULL>(check)) {
+            redundant_checks_.push_back(check);
+            return;
+        }
+        break;
+    default:
+        // TODO: analyze if statements for CHECK_SIZE - requires range analysis
+        break;
     }
+
+    MakeAvailable(key);
 }
 
-void CheckElimination::VisitCHECK_SIZE([[maybe_unused]] GraphVisitor* v, InstBase* inst)
+void CheckElimination::MakeAvailable(const CheckKey& key)
 {
-    ASSERT(inst->GetOpcode() == isa::inst::Opcode::CHECK_SIZE);
+    if (available_.insert(key).second) {
+        scope_log_.push_back(key);
+    }
+}
 
-    DeleteDominatedChecks<isa::inst::Opcode::CHECK_SIZE>(
-        inst, DefaultEquivalenceCheck<isa::inst::Opcode::CHECK_SIZE>);
+void CheckElimination::RemoveRedundantChecks()
+{
+    for (const auto i : redundant_checks_) {
+        DeleteCheck(i);
+    }
+}
 
-    // TODO: analyze if statements - requires range analysis
+void CheckElimination::ResetStructs()
+{
+    dom_children_.clear();
+    available_.clear();
+    scope_log_.clear();
+    redundant_checks_.clear();
 }
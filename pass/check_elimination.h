@@ -1,15 +1,21 @@
 #ifndef __CHECK_ELIMINATION_H_INCLUDED__
 #define __CHECK_ELIMINATION_H_INCLUDED__
 
-#include "ir/graph_visitor.h"
+#include "ir/inst.h"
 #include "pass.h"
 
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class BasicBlock;
-class InstBase;
 
-class CheckElimination : public Pass, public GraphVisitor
+// removes checks, that are dominated by an equivalent check or by a branch, which condition
+// implies the check, and checks of constants, that always pass.
+//
+// dominator tree is walked once, checks available on the path from the root are kept in a
+// scoped hash table, so each check is processed in O(1) on average
+class CheckElimination : public Pass
 {
   public:
     CheckElimination(Graph* graph) : Pass(graph)
@@ -19,16 +25,39 @@ class CheckElimination : public Pass, public GraphVisitor
     bool Run() override;
 
   private:
+    // identifies class of equivalent checks
+    struct CheckKey
+    {
+        isa::inst::Opcode opcode{ isa::inst::Opcode::N_OPCODES };
+        IdType subject{};
+        // second input is compared by value if it is a constant
+        bool arg_is_const{ false };
+        InstBase::DataType arg_type{ InstBase::DataType::VOID };
+        uint64_t arg{ 0 };
+
+        bool operator==(const CheckKey& other) const = default;
+
+        struct Hash
+        {
+            size_t operator()(const CheckKey& key) const;
+        };
+    };
+
+    void BuildDomTree();
+    void VisitBlock(BasicBlock* bb);
+    void AddImpliedChecks(BasicBlock* bb);
+    void VisitCheck(InstBase* check);
+    void MakeAvailable(const CheckKey& key);
     void RemoveRedundantChecks();
     void ResetStructs();
 
-    static void VisitCHECK_ZERO(GraphVisitor* v, InstBase* inst);
-    static void VisitCHECK_NULL(GraphVisitor* v, InstBase* inst);
-    static void VisitCHECK_SIZE([[maybe_unused]] GraphVisitor* v, InstBase* inst);
+    static CheckKey GetCheckKey(const InstBase* check);
 
+    std::unordered_map<BasicBlock*, std::vector<BasicBlock*> > dom_children_{};
+    std::unordered_set<CheckKey, CheckKey::Hash> available_{};
+    // keys added to available_, popped when leaving dominator tree subtree
+    std::vector<CheckKey> scope_log_{};
     std::vector<InstBase*> redundant_checks_{};
-
-#include "ir/graph_visitor.inc"
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,61 +4,59 @@
 
 bool DCE::Run()
 {
-    Markers markers{};
+    InstTable table(graph_);
+    std::vector<bool> live(table.Size(), false);
 
-    Mark(markers);
-    Sweep(markers);
+    Mark(table, &live);
+    Sweep(table, live);
 
     return true;
 }
 
-void DCE::Mark(const Markers markers)
+void DCE::Mark(const InstTable& table, std::vector<bool>* live)
 {
-    for (const auto& bb : graph_->GetPassManager()->GetValidPass<PO>()->GetBlocks()) {
-        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
-            if (inst->HasFlag<isa::flag::Type::NO_DCE>()) {
-                MarkRecursively(inst, markers);
-            }
+    // explicit worklist, so long def-use chains don't overflow the stack
+    std::vector<InstTable::Index> worklist{};
+    for (InstTable::Index idx = 0; idx < table.Size(); ++idx) {
+        if (table.HasFlag<isa::flag::Type::NO_DCE>(idx)) {
+            (*live)[idx] = true;
+            worklist.push_back(idx);
         }
     }
-}
 
-void DCE::MarkRecursively(InstBase* inst, const Markers markers)
-{
-    if (inst->SetMark(&markers[Marks::VISITED])) {
-        return;
-    }
+    while (!worklist.empty()) {
+        auto idx = worklist.back();
+        worklist.pop_back();
 
-    for (const auto& i : inst->GetInputs()) {
-        MarkRecursively(i.GetInst(), markers);
+        for (auto input : table.GetInputs(idx)) {
+            if (!(*live)[input]) {
+                (*live)[input] = true;
+                worklist.push_back(input);
+            }
+        }
     }
 }
 
-void DCE::Sweep(const Markers markers)
+void DCE::Sweep(const InstTable& table, const std::vector<bool>& live)
 {
-    for (const auto& bb : graph_->GetPassManager()->GetValidPass<PO>()->GetBlocks()) {
-        std::set<InstBase*> to_remove{};
-        for (auto inst = bb->GetLastInst(); inst != nullptr; inst = inst->GetPrev()) {
-            if (!inst->ProbeMark(&markers[Marks::VISITED])) {
-                for (const auto& i : inst->GetInputs()) {
-                    i.GetInst()->RemoveUser(inst);
-                }
-                to_remove.insert(inst);
-            }
-        }
+    // dead instructions may form cycles through phis of different blocks, so unlink them only
+    // after every dead instruction is detached from it's inputs
+    std::vector<InstBase*> to_remove{};
 
-        for (auto phi = bb->GetLastPhi(); phi != nullptr; phi = phi->GetPrev()) {
-            if (!phi->ProbeMark(&markers[Marks::VISITED])) {
-                for (const auto& i : phi->GetInputs()) {
-                    i.GetInst()->RemoveUser(phi);
-                }
-                to_remove.insert(phi);
-            }
+    for (InstTable::Index idx = 0; idx < table.Size(); ++idx) {
+        if (live[idx]) {
+            continue;
         }
 
-        for (auto inst : to_remove) {
-            ASSERT(inst != nullptr);
-            bb->UnlinkInst(inst);
+        auto inst = table.GetInst(idx);
+        for (auto input : inst->GetInputInsts()) {
+            input->RemoveUser(inst);
         }
+        to_remove.push_back(inst);
+    }
+
+    for (auto inst : to_remove) {
+        ASSERT(inst != nullptr);
+        inst->GetBasicBlock()->UnlinkInst(inst);
     }
 }
@@ -1,24 +1,16 @@
 #ifndef __DCE_H_INCLUDED__
 #define __DCE_H_INCLUDED__
 
+#include "ir/inst_table.h"
 #include "pass.h"
-#include "utils/marker/marker.h"
 
-class BasicBlock;
-class InstBase;
+#include <vector>
 
 class DCE : public Pass
 {
   public:
     using is_cfg_sensitive = std::true_type;
 
-    enum Marks
-    {
-        VISITED = 0,
-        N_MARKS,
-    };
-    using Markers = marker::Markers<Marks::N_MARKS>;
-
     DCE(Graph* graph) : Pass(graph)
     {
     }
@@ -26,9 +18,10 @@ class DCE : public Pass
     bool Run() override;
 
   private:
-    void Mark(const Markers markers);
-    void MarkRecursively(InstBase* inst, const Markers markers);
-    void Sweep(const Markers markers);
+    // liveness is computed over the compact InstTable, graph is touched only to remove
+    // dead instructions
+    void Mark(const InstTable& table, std::vector<bool>* live);
+    void Sweep(const InstTable& table, const std::vector<bool>& live);
 };
 
-#endif
\ No newline at end of file
+#endif
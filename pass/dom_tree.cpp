@@ -13,6 +13,7 @@ bool DomTree::Run()
     FillTree();
     ComputeSdoms();
     ComputeDoms();
+    NumberTree();
 
     SetValid(true);
 
@@ -27,9 +28,26 @@ void DomTree::ComputeDoms()
         }
 
         w->bb->SetImmDominator(w->dom->bb);
+        w->dom->children.push_back(&(*w));
     }
 }
 
+// a dominates b iff a's [in, out] interval contains b's one, so dominance queries are O(1)
+void DomTree::NumberTree()
+{
+    counter_ = 0;
+    NumberTree_(&(tree_.at(0)));
+}
+
+void DomTree::NumberTree_(Node* node)
+{
+    auto in = ++counter_;
+    for (auto child : node->children) {
+        NumberTree_(child);
+    }
+    node->bb->SetDomNumbers(in, ++counter_);
+}
+
 void DomTree::ComputeSdoms()
 {
     for (auto w = tree_.rbegin(); w != tree_.rend() - 1; ++w) {
@@ -38,6 +38,7 @@ class DomTree : public Pass
 
         std::vector<Node*> bucket{};
         std::vector<Node*> pred{};
+        std::vector<Node*> children{};
 
         unsigned dfs_idx{};
 
@@ -47,6 +48,8 @@ class DomTree : public Pass
     void FillTree();
     void FillTree_(Node* node);
     void ComputeDoms();
+    void NumberTree();
+    void NumberTree_(Node* node);
     void ComputeSdoms();
     void Link(Node* v, Node* w);
     Node* Eval(Node* v);
@@ -55,6 +58,7 @@ class DomTree : public Pass
 
     std::unordered_map<IdType, unsigned> id_to_dfs_idx_{};
     std::vector<Node> tree_{};
+    uint32_t counter_{ 0 };
 };
 
 #endif
@@ -0,0 +1,92 @@
+#include "dominance_frontier.h"
+#include "dom_tree.h"
+#include "ir/bb.h"
+#include "ir/graph.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+bool DominanceFrontier::Run()
+{
+    ResetState();
+
+    graph_->GetPassManager()->GetValidPass<DomTree>();
+    auto blocks = graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        rpo_idx_[blocks[i]] = i;
+    }
+
+    // only join points belong to dominance frontiers. walk up from each predecessor until
+    // immediate dominator of the join point is reached
+    for (auto bb : blocks) {
+        if (bb->GetNumPredecessors() < 2) {
+            continue;
+        }
+
+        for (auto pred : bb->GetPredecessors()) {
+            if (rpo_idx_.count(pred) == 0) {
+                continue;
+            }
+
+            for (auto runner = pred; runner != bb->GetImmDominator();
+                 runner = runner->GetImmDominator()) {
+                ASSERT(runner != nullptr);
+
+                auto& frontier = frontiers_[runner];
+                if (std::find(frontier.begin(), frontier.end(), bb) == frontier.end()) {
+                    frontier.push_back(bb);
+                }
+            }
+        }
+    }
+
+    SetValid(true);
+
+    return true;
+}
+
+std::vector<BasicBlock*> DominanceFrontier::GetFrontier(BasicBlock* bb) const
+{
+    ASSERT(bb != nullptr);
+
+    auto it = frontiers_.find(bb);
+    return (it == frontiers_.end()) ? std::vector<BasicBlock*>{} : it->second;
+}
+
+std::vector<BasicBlock*> DominanceFrontier::GetIteratedFrontier(
+    const std::vector<BasicBlock*>& blocks) const
+{
+    std::vector<BasicBlock*> res{};
+    std::unordered_set<BasicBlock*> in_res{};
+    std::vector<BasicBlock*> worklist{ blocks };
+
+    while (!worklist.empty()) {
+        auto bb = worklist.back();
+        worklist.pop_back();
+
+        auto it = frontiers_.find(bb);
+        if (it == frontiers_.end()) {
+            continue;
+        }
+
+        for (auto df : it->second) {
+            if (in_res.insert(df).second) {
+                res.push_back(df);
+                worklist.push_back(df);
+            }
+        }
+    }
+
+    std::sort(res.begin(), res.end(), [this](BasicBlock* lhs, BasicBlock* rhs) {
+        return rpo_idx_.at(lhs) < rpo_idx_.at(rhs);
+    });
+
+    return res;
+}
+
+void DominanceFrontier::ResetState()
+{
+    frontiers_.clear();
+    rpo_idx_.clear();
+}
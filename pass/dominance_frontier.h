@@ -0,0 +1,38 @@
+#ifndef __PASS_DOMINANCE_FRONTIER_INCLUDED__
+#define __PASS_DOMINANCE_FRONTIER_INCLUDED__
+
+#include <unordered_map>
+#include <vector>
+
+#include "pass.h"
+
+class BasicBlock;
+
+// dominance frontier of block b is the set of blocks, where b's dominance ends: b dominates a
+// predecessor of such block, but does not strictly dominate the block itself. computed as in
+// Cooper, Harvey, Kennedy "A Simple, Fast Dominance Algorithm"
+class DominanceFrontier : public Pass
+{
+  public:
+    using is_cfg_sensitive = std::true_type;
+
+    DominanceFrontier(Graph* graph) : Pass(graph)
+    {
+    }
+
+    bool Run() override;
+
+    // blocks in order of RPO. empty for unreachable blocks
+    std::vector<BasicBlock*> GetFrontier(BasicBlock* bb) const;
+    // closure of dominance frontier over the set of blocks - blocks, where phis for values
+    // defined in blocks should be placed. blocks in order of RPO
+    std::vector<BasicBlock*> GetIteratedFrontier(const std::vector<BasicBlock*>& blocks) const;
+
+  private:
+    void ResetState();
+
+    std::unordered_map<BasicBlock*, std::vector<BasicBlock*> > frontiers_{};
+    std::unordered_map<BasicBlock*, size_t> rpo_idx_{};
+};
+
+#endif
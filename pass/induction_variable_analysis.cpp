@@ -0,0 +1,243 @@
+#include "induction_variable_analysis.h"
+#include "ir/bb.h"
+#include "ir/graph.h"
+#include "ir/loop.h"
+
+#include <algorithm>
+
+using BinImmT = isa::inst_type::BIN_IMM;
+
+// returns true and sets step if update is i + step, where i is phi
+static bool MatchStep(const InstBase* phi, const InstBase* update, int64_t* step)
+{
+    ASSERT(phi != nullptr);
+    ASSERT(update != nullptr);
+    ASSERT(step != nullptr);
+
+    switch (update->GetOpcode()) {
+    case isa::inst::Opcode::ADDI:
+    case isa::inst::Opcode::SUBI: {
+        if (update->GetInput(0).GetInst() != phi) {
+            return false;
+        }
+        auto imm = static_cast<const BinImmT*>(update)->GetIntegralImm(0);
+        if (!imm.has_value()) {
+            return false;
+        }
+        if (update->GetOpcode() == isa::inst::Opcode::ADDI) {
+            *step = *imm;
+            return true;
+        }
+        return !__builtin_sub_overflow(int64_t{ 0 }, *imm, step);
+    }
+    case isa::inst::Opcode::ADD: {
+        auto in0 = update->GetInput(0).GetInst();
+        auto in1 = update->GetInput(1).GetInst();
+        if (in0 == phi && in1->IsIntegralConst()) {
+            *step = in1->GetIntegralConst();
+            return true;
+        }
+        if (in1 == phi && in0->IsIntegralConst()) {
+            *step = in0->GetIntegralConst();
+            return true;
+        }
+        return false;
+    }
+    case isa::inst::Opcode::SUB: {
+        auto in0 = update->GetInput(0).GetInst();
+        auto in1 = update->GetInput(1).GetInst();
+        if (in0 == phi && in1->IsIntegralConst()) {
+            return !__builtin_sub_overflow(int64_t{ 0 }, in1->GetIntegralConst(), step);
+        }
+        return false;
+    }
+    default:
+        return false;
+    }
+}
+
+// returns true and sets scale if inst is base * scale
+static bool MatchScale(const InstBase* base, const InstBase* inst, int64_t* scale)
+{
+    ASSERT(base != nullptr);
+    ASSERT(inst != nullptr);
+    ASSERT(scale != nullptr);
+
+    static constexpr int64_t MAX_SHIFT = 62;
+
+    switch (inst->GetOpcode()) {
+    case isa::inst::Opcode::MULI: {
+        if (inst->GetInput(0).GetInst() != base) {
+            return false;
+        }
+        auto imm = static_cast<const BinImmT*>(inst)->GetIntegralImm(0);
+        if (!imm.has_value()) {
+            return false;
+        }
+        *scale = *imm;
+        return true;
+    }
+    case isa::inst::Opcode::SHLI: {
+        if (inst->GetInput(0).GetInst() != base) {
+            return false;
+        }
+        auto shift = static_cast<const BinImmT*>(inst)->GetIntegralImm(0);
+        if (!shift.has_value() || *shift < 0 || *shift > MAX_SHIFT) {
+            return false;
+        }
+        *scale = int64_t{ 1 } << *shift;
+        return true;
+    }
+    case isa::inst::Opcode::MUL: {
+        auto in0 = inst->GetInput(0).GetInst();
+        auto in1 = inst->GetInput(1).GetInst();
+        if (in0 == base && in1->IsIntegralConst()) {
+            *scale = in1->GetIntegralConst();
+            return true;
+        }
+        if (in1 == base && in0->IsIntegralConst()) {
+            *scale = in0->GetIntegralConst();
+            return true;
+        }
+        return false;
+    }
+    default:
+        return false;
+    }
+}
+
+bool InductionVariableAnalysis::Run()
+{
+    ResetState();
+
+    auto root = graph_->GetPassManager()->GetValidPass<LoopAnalysis>()->GetRootLoop();
+    for (auto loop : root->GetInnerLoops()) {
+        AnalyzeLoop(loop);
+    }
+
+    SetValid(true);
+
+    return true;
+}
+
+void InductionVariableAnalysis::AnalyzeLoop(Loop* loop)
+{
+    ASSERT(loop != nullptr);
+
+    for (auto inner : loop->GetInnerLoops()) {
+        AnalyzeLoop(inner);
+    }
+
+    if (!loop->IsReducible() || loop->GetPreHeader() == nullptr ||
+        loop->GetBackEdges().size() != 1) {
+        return;
+    }
+
+    CollectBasicInductionVariables(loop);
+    CollectDerivedInductionVariables(loop);
+}
+
+void InductionVariableAnalysis::CollectBasicInductionVariables(Loop* loop)
+{
+    auto header = loop->GetHeader();
+    auto pre_header = loop->GetPreHeader();
+    auto back_edge = loop->GetBackEdges().front();
+
+    for (auto phi = header->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        ASSERT(phi->IsPhi());
+
+        InstBase* init = nullptr;
+        InstBase* update = nullptr;
+        auto sources = phi->GetPhiSources();
+        for (unsigned i = 0; i < sources.size(); ++i) {
+            if (sources[i] == pre_header) {
+                init = phi->GetInputInsts()[i];
+            } else if (sources[i] == back_edge) {
+                update = phi->GetInputInsts()[i];
+            }
+        }
+
+        if (phi->GetNumInputs() != 2 || init == nullptr || update == nullptr) {
+            continue;
+        }
+
+        if (!loop->Contains(update->GetBasicBlock())) {
+            continue;
+        }
+
+        int64_t step = 0;
+        if (!MatchStep(phi, update, &step)) {
+            continue;
+        }
+
+        basic_ivs_[loop].push_back(BasicInductionVariable{ loop, phi, init, update, step });
+    }
+}
+
+void InductionVariableAnalysis::CollectDerivedInductionVariables(Loop* loop)
+{
+    if (basic_ivs_.count(loop) == 0) {
+        return;
+    }
+
+    for (const auto& iv : basic_ivs_.at(loop)) {
+        for (const auto& user : iv.phi->GetUsers()) {
+            auto inst = user.GetInst();
+            if (!loop->Contains(inst->GetBasicBlock())) {
+                continue;
+            }
+
+            int64_t scale = 0;
+            if (MatchScale(iv.phi, inst, &scale)) {
+                derived_ivs_[loop].push_back(DerivedInductionVariable{ inst, iv.phi, scale });
+            }
+        }
+    }
+}
+
+std::vector<InductionVariableAnalysis::BasicInductionVariable>
+InductionVariableAnalysis::GetBasicInductionVariables(Loop* loop) const
+{
+    if (basic_ivs_.count(loop) == 0) {
+        return {};
+    }
+    return basic_ivs_.at(loop);
+}
+
+std::vector<InductionVariableAnalysis::DerivedInductionVariable>
+InductionVariableAnalysis::GetDerivedInductionVariables(Loop* loop) const
+{
+    if (derived_ivs_.count(loop) == 0) {
+        return {};
+    }
+    return derived_ivs_.at(loop);
+}
+
+const InductionVariableAnalysis::BasicInductionVariable*
+InductionVariableAnalysis::GetBasicInductionVariable(const InstBase* phi) const
+{
+    ASSERT(phi != nullptr);
+
+    if (!phi->IsPhi()) {
+        return nullptr;
+    }
+
+    auto loop = phi->GetBasicBlock()->GetLoop();
+    if (loop == nullptr || basic_ivs_.count(loop) == 0) {
+        return nullptr;
+    }
+
+    const auto& ivs = basic_ivs_.at(loop);
+    auto it = std::find_if(ivs.begin(), ivs.end(),
+                           [phi](const BasicInductionVariable& iv) { return iv.phi == phi; });
+    if (it == ivs.end()) {
+        return nullptr;
+    }
+    return &(*it);
+}
+
+void InductionVariableAnalysis::ResetState()
+{
+    basic_ivs_.clear();
+    derived_ivs_.clear();
+}
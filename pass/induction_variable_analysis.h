@@ -0,0 +1,59 @@
+#ifndef __PASS_INDUCTION_VARIABLE_ANALYSIS_INCLUDED__
+#define __PASS_INDUCTION_VARIABLE_ANALYSIS_INCLUDED__
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "pass.h"
+
+class Loop;
+class InstBase;
+
+class InductionVariableAnalysis : public Pass
+{
+  public:
+    using is_cfg_sensitive = std::true_type;
+
+    // 1. i = PHI(init from pre-header, update from back edge)
+    // 2. update = ADDI i, step / SUBI i, step / ADD i, CONST / SUB i, CONST
+    struct BasicInductionVariable
+    {
+        Loop* loop{ nullptr };
+        InstBase* phi{ nullptr };
+        InstBase* init{ nullptr };
+        InstBase* update{ nullptr };
+        int64_t step{ 0 };
+    };
+
+    // j = MULI i, scale / MUL i, CONST / SHLI i, log2(scale), where i is basic induction variable
+    struct DerivedInductionVariable
+    {
+        InstBase* inst{ nullptr };
+        InstBase* base{ nullptr };
+        int64_t scale{ 0 };
+    };
+
+    InductionVariableAnalysis(Graph* graph) : Pass(graph)
+    {
+    }
+
+    bool Run() override;
+
+    std::vector<BasicInductionVariable> GetBasicInductionVariables(Loop* loop) const;
+    std::vector<DerivedInductionVariable> GetDerivedInductionVariables(Loop* loop) const;
+
+    // returns nullptr if phi is not basic induction variable
+    const BasicInductionVariable* GetBasicInductionVariable(const InstBase* phi) const;
+
+  private:
+    void AnalyzeLoop(Loop* loop);
+    void CollectBasicInductionVariables(Loop* loop);
+    void CollectDerivedInductionVariables(Loop* loop);
+    void ResetState();
+
+    std::unordered_map<Loop*, std::vector<BasicInductionVariable> > basic_ivs_{};
+    std::unordered_map<Loop*, std::vector<DerivedInductionVariable> > derived_ivs_{};
+};
+
+#endif
@@ -1,64 +1,205 @@
 #include "inlining.h"
 #include "ir/bb.h"
+#include "ir/call_graph.h"
 #include "ir/graph.h"
+#include "ir/graph_cloner.h"
+#include "ir/ssa_updater.h"
 
-GEN_DEFAULT_VISIT_FUNCTIONS(Inlining, RPO);
+#include <algorithm>
 
 Inlining::Inlining(Graph* graph) : Pass(graph)
 {
 }
 
+Inlining::~Inlining() = default;
+
+using CallStaticT = isa::inst::Inst<isa::inst::Opcode::CALL_STATIC>::Type;
+
 bool Inlining::Run()
 {
+    ResetState();
+
+    // collect call sites of the graph
     VisitGraph();
 
+    // graph is changed by inlining, so it's recursive calls are inlined from a copy
+    if (!call_sites_.empty() && CallGraph({ graph_ }).IsRecursive(graph_)) {
+        TakeSnapshot();
+    }
+
+    while (!call_sites_.empty()) {
+        auto site = std::move(call_sites_.front());
+        call_sites_.pop_front();
+
+        if (ShouldInline(site)) {
+            InlineStatic(site);
+        }
+    }
+
     for (auto inst : to_delete_) {
         inst->GetBasicBlock()->UnlinkInst(inst);
     }
     to_delete_.clear();
+    snapshot_.reset();
 
     return true;
 }
 
-void Inlining::VisitCALL_STATIC(GraphVisitor* v, InstBase* inst)
+std::vector<BasicBlock*> Inlining::BlockOrder() const
 {
-    using T = typename isa::inst::Inst<isa::inst::Opcode::CALL_STATIC>::Type;
+    return graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+}
 
-    ASSERT(v != nullptr);
+void Inlining::VisitCALL_STATIC(InstBase* inst)
+{
     ASSERT(inst != nullptr);
     ASSERT(inst->GetOpcode() == isa::inst::Opcode::CALL_STATIC);
 
-    auto _this = static_cast<Inlining*>(v);
-
-    _this->cur_call_ = inst;
-    _this->callee_start_bb_ = static_cast<T*>(inst)->GetCallee()->GetStartBasicBlock();
-
-    _this->UpdateDFGParameters();
-    _this->UpdateDFGReturns();
-    _this->MoveConstants();
-    _this->MoveCalleeBlocks();
-    _this->InsertInlinedGraph();
-    _this->ResetState();
+    call_sites_.push_back(CallSite{ inst, {} });
 }
 
 void Inlining::ResetState()
+{
+    call_sites_.clear();
+    callee_sizes_.clear();
+    growth_ = 0;
+    snapshot_.reset();
+    ResetCallState();
+}
+
+void Inlining::ResetCallState()
 {
     ret_bbs_.clear();
+    ret_values_.clear();
     cur_call_ = nullptr;
     callee_start_bb_ = nullptr;
 }
 
-void Inlining::UpdateDFGParameters()
+void Inlining::TakeSnapshot()
+{
+    snapshot_ = std::make_unique<Graph>();
+
+    GraphCloner cloner{ snapshot_.get() };
+    cloner.MapBlock(graph_->GetStartBasicBlock(), snapshot_->GetStartBasicBlock());
+    cloner.CloneGraph(graph_);
+}
+
+Graph* Inlining::GetInlinedGraph(InstBase* call) const
+{
+    auto callee = static_cast<CallStaticT*>(call)->GetCallee();
+    // graph can't be cloned into itself
+    return (callee == graph_) ? snapshot_.get() : callee;
+}
+
+bool Inlining::ShouldInline(const CallSite& site)
+{
+    auto callee = static_cast<CallStaticT*>(site.call)->GetCallee();
+    auto inlined = GetInlinedGraph(site.call);
+    if (inlined == nullptr) {
+        return false;
+    }
+
+    if (site.chain.size() >= MAX_INLINE_DEPTH) {
+        return false;
+    }
+
+    auto depth = std::count(site.chain.begin(), site.chain.end(), callee);
+    if (static_cast<unsigned>(depth) >= MAX_RECURSIVE_DEPTH) {
+        return false;
+    }
+
+    if (GetCallCost(site.call) > INLINE_COST_THRESHOLD) {
+        return false;
+    }
+
+    return growth_ + GetCalleeSize(inlined) <= CALLER_GROWTH_BUDGET;
+}
+
+size_t Inlining::GetCallCost(InstBase* call)
+{
+    auto callee = GetInlinedGraph(call);
+    auto cost = GetCalleeSize(callee);
+
+    // users of parameters, that receive constants, are likely to be folded after inlining
+    auto param = callee->GetStartBasicBlock()->GetFirstInst();
+    for (auto arg : call->GetInputInsts()) {
+        ASSERT(param != nullptr && param->IsParam());
+
+        if (arg->IsConst()) {
+            cost -= std::min(cost, param->GetNumUsers());
+        }
+        param = param->GetNext();
+    }
+
+    return cost;
+}
+
+size_t Inlining::GetCalleeSize(Graph* callee)
+{
+    if (callee_sizes_.count(callee) != 0) {
+        return callee_sizes_.at(callee);
+    }
+
+    size_t size = 0;
+    for (auto bb : callee->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        for (auto inst = bb->GetFirstPhi(); inst != nullptr; inst = inst->GetNext()) {
+            ++size;
+        }
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            if (!inst->IsParam() && !inst->IsConst()) {
+                ++size;
+            }
+        }
+    }
+
+    callee_sizes_[callee] = size;
+    return size;
+}
+
+void Inlining::InlineStatic(const CallSite& site)
+{
+    auto callee = GetInlinedGraph(site.call);
+
+    cur_call_ = site.call;
+    growth_ += GetCalleeSize(callee);
+
+    // callee is cloned, so it stays intact and may be inlined into other call sites
+    GraphCloner cloner{ graph_ };
+    UpdateDFGParameters(callee, &cloner);
+    cloner.CloneGraph(callee);
+    callee_start_bb_ = cloner.GetClone(callee->GetStartBasicBlock());
+
+    CollectCallSites(callee, cloner, site);
+    UpdateDFGReturns(callee, cloner);
+    MoveConstants();
+    InsertInlinedGraph();
+    ResetCallState();
+}
+
+// calls of the inlined callee are inlined after the calls of the caller
+void Inlining::CollectCallSites(Graph* callee, const GraphCloner& cloner, const CallSite& site)
 {
-    auto param = callee_start_bb_->GetFirstInst();
-    for (const auto& arg : cur_call_->GetInputs()) {
+    auto chain = site.chain;
+    chain.push_back(static_cast<CallStaticT*>(site.call)->GetCallee());
+
+    for (auto bb : callee->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            if (inst->GetOpcode() == isa::inst::Opcode::CALL_STATIC) {
+                call_sites_.push_back(CallSite{ cloner.GetClone(inst), chain });
+            }
+        }
+    }
+}
+
+// parameters are not cloned, their uses are replaced with arguments
+void Inlining::UpdateDFGParameters(Graph* callee, GraphCloner* cloner)
+{
+    auto param = callee->GetStartBasicBlock()->GetFirstInst();
+    for (auto arg : cur_call_->GetInputInsts()) {
         // argument number mismatch
         ASSERT(param->IsParam());
 
-        for (const auto& user : param->GetUsers()) {
-            user.GetInst()->ReplaceInput(param, arg.GetInst());
-            arg.GetInst()->AddUser(user);
-        }
+        cloner->MapValue(param, arg);
         param = param->GetNext();
     }
 
@@ -66,19 +207,17 @@ void Inlining::UpdateDFGParameters()
     ASSERT(param == nullptr || !param->IsParam());
 }
 
-// move caller users to return input instruction(or PHI instructions for several return
-// instructions)
-void Inlining::UpdateDFGReturns()
+// returns are removed, returned values are collected to replace the call result after callee
+// blocks are linked to the caller
+void Inlining::UpdateDFGReturns(Graph* callee, const GraphCloner& cloner)
 {
-    auto call_inst =
-        static_cast<typename isa::inst::Inst<isa::inst::Opcode::CALL_STATIC>::Type*>(cur_call_);
-    auto callee_blocks =
-        call_inst->GetCallee()->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+    auto callee_blocks = callee->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
 
     std::vector<InstBase*> rets{};
-    for (const auto& bb : callee_blocks) {
+    for (const auto& callee_bb : callee_blocks) {
+        auto bb = cloner.GetClone(callee_bb);
         auto last_inst = bb->GetLastInst();
-        if (last_inst->IsReturn()) {
+        if (last_inst != nullptr && last_inst->IsReturn()) {
             rets.push_back(last_inst);
             ret_bbs_.push_back(bb);
         }
@@ -86,38 +225,37 @@ void Inlining::UpdateDFGReturns()
 
     ASSERT(!rets.empty());
 
-    // only one return type per function, so decide by first one
-    if (rets.front()->GetNumInputs() == 0) {
-        for (const auto& ret : rets) {
-            ret->GetBasicBlock()->UnlinkInst(ret);
-        }
-    } else {
-        ASSERT(rets.front()->GetNumInputs() > 0);
-
-        InstBase* call_ret_res{ nullptr };
-        if (rets.size() == 1) {
-            call_ret_res = rets.front()->GetInput(0).GetInst();
-            call_ret_res->RemoveUser(rets.front());
-            rets.front()->GetBasicBlock()->UnlinkInst(rets.front());
-        } else {
-            ret_phi_ = InstBase::NewInst<isa::inst::Opcode::PHI>();
-            call_ret_res = ret_phi_.get();
-
-            ASSERT(call_ret_res != nullptr);
-
-            for (const auto& ret : rets) {
-                // input is ret's input, but phi's bb is bb, where ret was
-                auto ret_input = ret->GetInput(0).GetInst();
-                ret_phi_->AddInput(ret_input, ret->GetBasicBlock());
-                ret_input->RemoveUser(ret);
-                ret->GetBasicBlock()->UnlinkInst(ret);
-            }
-        }
+    // only one return type per function
+    [[maybe_unused]] auto num_inputs = rets.front()->GetNumInputs();
+    for (const auto& ret : rets) {
+        ASSERT(ret->GetNumInputs() == num_inputs);
 
-        for (const auto& user : call_inst->GetUsers()) {
-            user.GetInst()->ReplaceInput(call_inst, call_ret_res);
-            call_ret_res->AddUser(user);
+        if (ret->GetNumInputs() != 0) {
+            auto ret_input = ret->GetInput(0).GetInst();
+            ret_values_.emplace_back(ret->GetBasicBlock(), ret_input);
+            ret_input->RemoveUser(ret);
         }
+        ret->GetBasicBlock()->UnlinkInst(ret);
+    }
+}
+
+// call users are moved to the returned value (or to phi of returned values for several return
+// instructions)
+void Inlining::UpdateDFGCallUsers(BasicBlock* call_cont_block)
+{
+    if (ret_values_.empty()) {
+        return;
+    }
+
+    SSAUpdater updater{ cur_call_->GetDataType() };
+    for (const auto& [ret_bb, ret_value] : ret_values_) {
+        updater.AddDefinition(ret_bb, ret_value);
+    }
+
+    auto call_ret_res = updater.GetValueAtEntry(call_cont_block);
+    for (const auto& user : cur_call_->GetUsers()) {
+        user.GetInst()->ReplaceInput(cur_call_, call_ret_res);
+        call_ret_res->AddUser(user);
     }
 }
 
@@ -136,41 +274,22 @@ void Inlining::MoveConstants()
     auto first_last_inst = first->GetLastInst();
 
     auto second_first_inst = std::unique_ptr<InstBase>{ second->TransferInst() };
-
-    ASSERT(second_first_inst->GetPrev() == nullptr);
-    // delete parameters
-    while (second_first_inst != nullptr && second_first_inst->IsParam()) {
-        second_first_inst.reset(second_first_inst->ReleaseNext());
+    // parameters are not cloned, so callee start block may be empty
+    if (second_first_inst == nullptr) {
+        return;
     }
 
-    if (second_first_inst != nullptr) {
-        second_first_inst->SetPrev(nullptr);
-
-        ASSERT(second_last_inst != nullptr);
-
-        second_first_inst->SetPrev(first_last_inst);
-        auto inst = second_first_inst.get();
-        while (inst != nullptr) {
-            if (inst->IsConst()) {
-            }
-            ASSERT(inst->IsConst() || inst->IsParam());
-            inst->SetBasicBlock(first);
-            inst = inst->GetNext();
-        }
+    ASSERT(second_first_inst->GetPrev() == nullptr);
+    ASSERT(second_last_inst != nullptr);
 
-        first->PushBackInst(std::move(second_first_inst));
-        first->SetLastInst(second_last_inst);
+    second_first_inst->SetPrev(first_last_inst);
+    for (auto inst = second_first_inst.get(); inst != nullptr; inst = inst->GetNext()) {
+        ASSERT(inst->IsConst());
+        inst->SetBasicBlock(first);
     }
-}
 
-void Inlining::MoveCalleeBlocks()
-{
-    auto call_inst =
-        static_cast<typename isa::inst::Inst<isa::inst::Opcode::CALL_STATIC>::Type*>(cur_call_);
-    auto callee = call_inst->GetCallee();
-    for (const auto& bb : callee->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
-        graph_->NewBasicBlock(callee->ReleaseBasicBlock(bb->GetId()));
-    }
+    first->PushBackInst(std::move(second_first_inst));
+    first->SetLastInst(second_last_inst);
 }
 
 void Inlining::InsertInlinedGraph()
@@ -181,8 +300,8 @@ void Inlining::InsertInlinedGraph()
     auto call_cont_block = call_block->GetSuccessor(0);
 
     // remove call instruction by hand
-    for (const auto& input : cur_call_->GetInputs()) {
-        input.GetInst()->RemoveUser(cur_call_);
+    for (auto input : cur_call_->GetInputInsts()) {
+        input->RemoveUser(cur_call_);
     }
     ASSERT(cur_call_->GetBasicBlock()->GetId() == call_block->GetId());
     to_delete_.push_back(cur_call_);
@@ -191,10 +310,6 @@ void Inlining::InsertInlinedGraph()
     ASSERT(call_cont_block->GetNumPredecessors() == 1);
     ASSERT(call_cont_block->GetPredecessor(0) == call_block);
 
-    if (ret_phi_.get() != nullptr) {
-        call_cont_block->PushBackPhi(std::move(ret_phi_));
-    }
-
     graph_->ReplaceSuccessor(call_block, call_cont_block, callee_start_bb_);
 
     ASSERT(call_block->GetNumSuccessors() ==
@@ -206,4 +321,6 @@ void Inlining::InsertInlinedGraph()
     for (const auto& ret_bb : ret_bbs_) {
         graph_->AddEdge(ret_bb, call_cont_block, Conditional::Branch::FALLTHROUGH);
     }
+
+    UpdateDFGCallUsers(call_cont_block);
 }
@@ -1,19 +1,38 @@
 #ifndef __PASS_INLINING_INCLUDED__
 #define __PASS_INLINING_INCLUDED__
 
-#include <memory>
+#include <deque>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "ir/graph_visitor.h"
 #include "pass.h"
 
 class BasicBlock;
+class Graph;
+class GraphCloner;
 class InstBase;
 
-class Inlining : public Pass, public GraphVisitor
+// inlines static calls, which cost fits into the threshold, until caller's growth budget is
+// exhausted. calls from inlined callees are considered as well, recursive callees are inlined up
+// to a fixed depth. calls of the graph to itself (directly or through other callees) are
+// inlined from a copy of the graph, taken before the graph is changed
+class Inlining : public Pass, public GraphVisitor<Inlining>
 {
   public:
+    // cost of a call site is the number of callee's instructions (except parameters and
+    // constants), that are not going to be folded because of constant arguments
+    static constexpr size_t INLINE_COST_THRESHOLD = 32;
+    // maximum number of instructions inlined into one caller
+    static constexpr size_t CALLER_GROWTH_BUDGET = 256;
+    // maximum nesting of inlined calls
+    static constexpr unsigned MAX_INLINE_DEPTH = 4;
+    // maximum number of times callee may appear in a chain of nested inlined calls
+    static constexpr unsigned MAX_RECURSIVE_DEPTH = 2;
+
     Inlining(Graph* graph);
+    ~Inlining() override;
 
     NO_COPY_SEMANTIC(Inlining);
     NO_MOVE_SEMANTIC(Inlining);
@@ -21,24 +40,47 @@ class Inlining : public Pass, public GraphVisitor
     bool Run() override;
 
   private:
+    struct CallSite
+    {
+        InstBase* call{ nullptr };
+        // callees inlined on the way to the call site
+        std::vector<Graph*> chain{};
+    };
+
     void ResetState();
-    void TryInlineStatic();
-    void UpdateDFGParameters();
-    void UpdateDFGReturns();
+    void ResetCallState();
+    void TakeSnapshot();
+    // graph, that is cloned in place of the call
+    Graph* GetInlinedGraph(InstBase* call) const;
+    bool ShouldInline(const CallSite& site);
+    size_t GetCallCost(InstBase* call);
+    size_t GetCalleeSize(Graph* callee);
+    void InlineStatic(const CallSite& site);
+    void UpdateDFGParameters(Graph* callee, GraphCloner* cloner);
+    void UpdateDFGReturns(Graph* callee, const GraphCloner& cloner);
+    void UpdateDFGCallUsers(BasicBlock* call_cont_block);
     void MoveConstants();
-    void MoveCalleeBlocks();
     void InsertInlinedGraph();
+    void CollectCallSites(Graph* callee, const GraphCloner& cloner, const CallSite& site);
+
+    std::deque<CallSite> call_sites_{};
+    std::unordered_map<Graph*, size_t> callee_sizes_{};
+    size_t growth_{ 0 };
+    // copy of the graph for it's recursive calls, nullptr if the graph is not recursive
+    std::unique_ptr<Graph> snapshot_{};
 
     InstBase* cur_call_{ nullptr };
     BasicBlock* callee_start_bb_{ nullptr };
     std::vector<BasicBlock*> ret_bbs_{};
+    std::vector<std::pair<BasicBlock*, InstBase*> > ret_values_{};
     std::vector<InstBase*> to_delete_{};
-    std::unique_ptr<InstBase> ret_phi_{ nullptr };
 
   private:
-    static void VisitCALL_STATIC(GraphVisitor* v, InstBase* inst);
+    friend GraphVisitor<Inlining>;
+
+    std::vector<BasicBlock*> BlockOrder() const;
 
-#include "ir/graph_visitor.inc"
+    void VisitCALL_STATIC(InstBase* inst);
 };
 
 #endif
@@ -0,0 +1,276 @@
+#include "jump_threading.h"
+#include "dom_tree.h"
+#include "ir/bb.h"
+#include "ir/graph.h"
+#include "ir/graph_cloner.h"
+#include "ir/ssa_updater.h"
+
+// value of phi of bb on the edge from pred, value itself otherwise
+static InstBase* GetValueOnEdge(InstBase* value, BasicBlock* bb, BasicBlock* pred)
+{
+    if (value->IsPhi() && value->GetBasicBlock() == bb) {
+        return value->GetPhiInput(pred);
+    }
+    return value;
+}
+
+// lhs cond rhs / lhs cond imm
+struct BranchInfo
+{
+    Conditional::Type cond{ Conditional::Type::UNSET };
+    InstBase* lhs{ nullptr };
+    // nullptr for IF_IMM
+    InstBase* rhs{ nullptr };
+    int64_t imm{ 0 };
+};
+
+// IF / IF_IMM with two different successors
+static std::optional<BranchInfo> GetBranch(BasicBlock* bb)
+{
+    auto last = bb->GetLastInst();
+    if (last == nullptr || bb->GetNumSuccessors() != 2) {
+        return std::nullopt;
+    }
+
+    auto succ_true = bb->GetSuccessor(Conditional::Branch::BRANCH_TRUE);
+    auto succ_false = bb->GetSuccessor(Conditional::Branch::FALLTHROUGH);
+    if (succ_true == nullptr || succ_false == nullptr || succ_true == succ_false) {
+        return std::nullopt;
+    }
+
+    BranchInfo res{};
+    if (last->GetOpcode() == isa::inst::Opcode::IF_IMM) {
+        using IfImmT = isa::inst::Inst<isa::inst::Opcode::IF_IMM>::Type;
+        auto imm = static_cast<IfImmT*>(last)->GetIntegralImm(0);
+        if (!imm.has_value()) {
+            return std::nullopt;
+        }
+        res.cond = static_cast<IfImmT*>(last)->GetCondition();
+        res.lhs = last->GetInput(0).GetInst();
+        res.imm = *imm;
+        return res;
+    }
+
+    if (last->GetOpcode() == isa::inst::Opcode::IF) {
+        using IfT = isa::inst::Inst<isa::inst::Opcode::IF>::Type;
+        res.cond = static_cast<IfT*>(last)->GetCondition();
+        res.lhs = last->GetInput(0).GetInst();
+        res.rhs = last->GetInput(1).GetInst();
+        return res;
+    }
+
+    return std::nullopt;
+}
+
+static Conditional::Branch GetSlot(bool outcome)
+{
+    return outcome ? Conditional::Branch::BRANCH_TRUE : Conditional::Branch::FALLTHROUGH;
+}
+
+// outcome of branch, if branch of from on the same operands led to to
+static std::optional<bool> GetOutcomeOnEdge(const BranchInfo& branch, BasicBlock* from,
+                                            BasicBlock* to)
+{
+    auto dominating = GetBranch(from);
+    if (!dominating.has_value()) {
+        return std::nullopt;
+    }
+
+    auto fact = dominating->cond;
+    if (from->GetSuccessor(Conditional::Branch::BRANCH_TRUE) != to) {
+        fact = Conditional::Inverse(fact);
+    }
+
+    if (branch.rhs == nullptr || dominating->rhs == nullptr) {
+        if (branch.rhs == dominating->rhs && branch.lhs == dominating->lhs &&
+            branch.imm == dominating->imm) {
+            return Conditional::Implies(fact, branch.cond);
+        }
+        return std::nullopt;
+    }
+
+    if (branch.lhs == dominating->lhs && branch.rhs == dominating->rhs) {
+        return Conditional::Implies(fact, branch.cond);
+    }
+    if (branch.lhs == dominating->rhs && branch.rhs == dominating->lhs) {
+        return Conditional::Implies(Conditional::Swap(fact), branch.cond);
+    }
+
+    return std::nullopt;
+}
+
+bool JumpThreading::Run()
+{
+    ResetState();
+
+    auto blocks = graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+    for (auto bb : blocks) {
+        ProcessBlock(bb);
+    }
+
+    graph_->RemoveUnreachableBlocks();
+
+    return true;
+}
+
+// blocks are threaded only if they are not loop headers, otherwise loop may get several entries
+bool JumpThreading::IsCandidate(BasicBlock* bb)
+{
+    if (bb->IsStartBlock() || !GetBranch(bb).has_value()) {
+        return false;
+    }
+
+    graph_->GetPassManager()->GetValidPass<DomTree>();
+    for (auto pred : bb->GetPredecessors()) {
+        if (bb->Dominates(pred)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void JumpThreading::ProcessBlock(BasicBlock* bb)
+{
+    if (!IsCandidate(bb)) {
+        return;
+    }
+
+    for (auto pred : bb->GetPredecessors()) {
+        // dominators are recomputed after previous threading
+        graph_->GetPassManager()->GetValidPass<DomTree>();
+
+        auto outcome = GetOutcome(bb, pred);
+        if (!outcome.has_value()) {
+            continue;
+        }
+
+        if (bb->GetNumPredecessors() == 1) {
+            // branch of the block with single predecessor is replaced with a jump
+            graph_->ReplaceBranchWithJump(bb, bb->GetSuccessor(GetSlot(*outcome)));
+            return;
+        }
+
+        // both edges of pred lead to bb
+        if (pred->GetNumSuccessors() == 2 && pred->GetSuccessor(0) == pred->GetSuccessor(1)) {
+            continue;
+        }
+
+        auto size = GetBlockSize(bb);
+        if (size > MAX_BLOCK_SIZE || growth_ + size > GRAPH_GROWTH_BUDGET) {
+            continue;
+        }
+
+        Thread(bb, pred, *outcome);
+        growth_ += size;
+    }
+}
+
+std::optional<bool> JumpThreading::GetOutcome(BasicBlock* bb, BasicBlock* pred)
+{
+    auto outcome = GetOutcomeFromConstants(bb, pred);
+    if (outcome.has_value()) {
+        return outcome;
+    }
+
+    return GetOutcomeFromDominators(bb, pred);
+}
+
+std::optional<bool> JumpThreading::GetOutcomeFromConstants(BasicBlock* bb, BasicBlock* pred)
+{
+    auto branch = GetBranch(bb);
+    ASSERT(branch.has_value());
+
+    auto lhs = GetValueOnEdge(branch->lhs, bb, pred);
+    if (!lhs->IsIntegralConst()) {
+        return std::nullopt;
+    }
+
+    auto rhs_val = branch->imm;
+    if (branch->rhs != nullptr) {
+        auto rhs = GetValueOnEdge(branch->rhs, bb, pred);
+        if (!rhs->IsIntegralConst()) {
+            return std::nullopt;
+        }
+        rhs_val = rhs->GetIntegralConst();
+    }
+
+    return Conditional::Evaluate(branch->cond, lhs->GetIntegralConst(), rhs_val);
+}
+
+// edge from pred to bb and edges to single-predecessor blocks, that dominate pred, are checked
+std::optional<bool> JumpThreading::GetOutcomeFromDominators(BasicBlock* bb, BasicBlock* pred)
+{
+    auto branch = GetBranch(bb);
+    ASSERT(branch.has_value());
+
+    auto outcome = GetOutcomeOnEdge(*branch, pred, bb);
+    for (auto dom = pred; !outcome.has_value() && dom != nullptr; dom = dom->GetImmDominator()) {
+        if (dom->GetNumPredecessors() == 1) {
+            outcome = GetOutcomeOnEdge(*branch, dom->GetPredecessor(0), dom);
+        }
+    }
+
+    return outcome;
+}
+
+// pred is redirected to a copy of bb without the branch, that jumps to the known successor
+void JumpThreading::Thread(BasicBlock* bb, BasicBlock* pred, bool outcome)
+{
+    auto branch = bb->GetLastInst();
+    auto target = bb->GetSuccessor(GetSlot(outcome));
+
+    GraphCloner cloner{ graph_ };
+    for (auto phi = bb->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        cloner.MapValue(phi, phi->GetPhiInput(pred));
+    }
+    cloner.Skip(branch);
+    cloner.CloneBlocks({ bb });
+    auto clone = cloner.GetClone(bb);
+
+    graph_->ReplaceSuccessor(pred, bb, clone);
+    bb->RemovePhiInputs(pred);
+
+    graph_->AddEdge(clone, target, Conditional::Branch::FALLTHROUGH);
+    for (auto phi = target->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        phi->AddInput(cloner.GetClone(phi->GetPhiInput(bb)), clone);
+    }
+
+    // values of bb, used outside of it, now have two definitions
+    std::vector<InstBase*> defs{};
+    for (auto phi = bb->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        defs.push_back(phi);
+    }
+    for (auto inst = bb->GetFirstInst(); inst != branch; inst = inst->GetNext()) {
+        defs.push_back(inst);
+    }
+
+    for (auto def : defs) {
+        bool used_outside = false;
+        for (const auto& user : def->GetUsers()) {
+            used_outside |= user.GetInst()->GetBasicBlock() != bb;
+        }
+        if (!used_outside) {
+            continue;
+        }
+
+        SSAUpdater updater{ def->GetDataType() };
+        updater.AddDefinition(bb, def);
+        updater.AddDefinition(clone, cloner.GetClone(def));
+        updater.RewriteUses(def);
+    }
+}
+
+size_t JumpThreading::GetBlockSize(BasicBlock* bb) const
+{
+    size_t size = 0;
+    for (auto inst = bb->GetFirstInst(); inst != bb->GetLastInst(); inst = inst->GetNext()) {
+        ++size;
+    }
+    return size;
+}
+
+void JumpThreading::ResetState()
+{
+    growth_ = 0;
+}
@@ -0,0 +1,50 @@
+#ifndef __PASS_JUMP_THREADING_INCLUDED__
+#define __PASS_JUMP_THREADING_INCLUDED__
+
+#include <optional>
+#include <vector>
+
+#include "ir/inst.h"
+#include "pass.h"
+
+class BasicBlock;
+
+// redirects predecessors of a block, ending with IF / IF_IMM, straight to the successor, if
+// branch outcome is known on the edge from the predecessor:
+// - operands are phis of the block, that receive constants from the predecessor
+// - predecessor is dominated by an edge of a branch on the same operands
+//
+// block is duplicated for the predecessor without the branch, values defined in the block are
+// repaired with SSAUpdater. if the last predecessor remains, branch is folded in place
+class JumpThreading : public Pass
+{
+  public:
+    // maximum number of instructions in duplicated block, not counting phis and the branch
+    static constexpr size_t MAX_BLOCK_SIZE = 8;
+    // maximum number of instructions added to the graph by the pass
+    static constexpr size_t GRAPH_GROWTH_BUDGET = 256;
+
+    JumpThreading(Graph* graph) : Pass(graph)
+    {
+    }
+
+    NO_COPY_SEMANTIC(JumpThreading);
+    NO_MOVE_SEMANTIC(JumpThreading);
+
+    bool Run() override;
+
+  private:
+    bool IsCandidate(BasicBlock* bb);
+    void ProcessBlock(BasicBlock* bb);
+    // branch outcome of bb on the edge from pred, nullopt if unknown
+    std::optional<bool> GetOutcome(BasicBlock* bb, BasicBlock* pred);
+    std::optional<bool> GetOutcomeFromConstants(BasicBlock* bb, BasicBlock* pred);
+    std::optional<bool> GetOutcomeFromDominators(BasicBlock* bb, BasicBlock* pred);
+    void Thread(BasicBlock* bb, BasicBlock* pred, bool outcome);
+    size_t GetBlockSize(BasicBlock* bb) const;
+    void ResetState();
+
+    size_t growth_{ 0 };
+};
+
+#endif
@@ -3,6 +3,11 @@
 #include "ir/graph.h"
 #include "ir/loop.h"
 
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
 using BranchFlag = isa::flag::Flag<isa::flag::Type::BRANCH>;
 
 void LinearOrder::AppendJump(BasicBlock* bb)
@@ -51,8 +56,10 @@ bool LinearOrder::Run()
 
 void LinearOrder::Linearize()
 {
+    auto blocks = BuildChainOrder();
+
     BasicBlock* prev = nullptr;
-    for (const auto& bb : graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+    for (const auto& bb : blocks) {
         if (prev != nullptr) {
             switch (prev->GetNumSuccessors()) {
             case BranchFlag::Value::NO_SUCCESSORS: {
@@ -80,6 +87,104 @@ void LinearOrder::Linearize()
     ProcessLast(prev);
 }
 
+std::vector<BasicBlock*> LinearOrder::BuildChainOrder()
+{
+    auto freq = graph_->GetPassManager()->GetValidPass<BlockFrequency>();
+    auto rpo = graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+
+    struct Edge
+    {
+        BasicBlock* from{ nullptr };
+        BasicBlock* to{ nullptr };
+        double weight{ 0.0 };
+    };
+
+    // every block starts it's own chain
+    std::vector<std::vector<BasicBlock*> > chains{};
+    std::unordered_map<BasicBlock*, size_t> chain_of{};
+    std::vector<Edge> edges{};
+    for (auto bb : rpo) {
+        chain_of[bb] = chains.size();
+        chains.push_back({ bb });
+
+        for (auto succ : bb->GetSuccessors()) {
+            auto weight = freq->GetEdgeFrequency(bb, succ);
+            if (weight > 0.0) {
+                edges.push_back({ bb, succ, weight });
+            }
+        }
+    }
+
+    // the hottest edges are made fall-throughs first, ties are resolved in RPO
+    std::stable_sort(edges.begin(), edges.end(),
+                     [](const Edge& l, const Edge& r) { return l.weight > r.weight; });
+
+    for (const auto& edge : edges) {
+        auto from_idx = chain_of.at(edge.from);
+        auto to_idx = chain_of.at(edge.to);
+        if (from_idx == to_idx || chains[from_idx].back() != edge.from ||
+            chains[to_idx].front() != edge.to || edge.to->IsStartBlock()) {
+            continue;
+        }
+
+        for (auto bb : chains[to_idx]) {
+            chain_of[bb] = from_idx;
+        }
+        chains[from_idx].insert(chains[from_idx].end(), chains[to_idx].begin(),
+                                chains[to_idx].end());
+        chains[to_idx].clear();
+    }
+
+    // chain of the start block goes first, then the chain with the hottest edges from the
+    // placed blocks to it's head. ties are resolved in RPO. heads are kept in a max-heap by the
+    // weight of incoming edges. weights only grow, so entries with less weight are outdated
+    using HeadEntry = std::pair<double, size_t>;
+    auto is_colder = [](const HeadEntry& l, const HeadEntry& r) {
+        return l.first < r.first || (!(r.first < l.first) && l.second > r.second);
+    };
+    std::priority_queue<HeadEntry, std::vector<HeadEntry>, decltype(is_colder)> heads{ is_colder };
+    std::vector<double> incoming(chains.size(), 0.0);
+    std::vector<bool> is_placed(chains.size(), false);
+    for (size_t idx = 0; idx < chains.size(); ++idx) {
+        if (!chains[idx].empty()) {
+            heads.emplace(0.0, idx);
+        }
+    }
+
+    auto is_outdated = [&is_placed, &incoming](const HeadEntry& e) {
+        return is_placed[e.second] || e.first < incoming[e.second];
+    };
+
+    std::vector<BasicBlock*> order{};
+    auto next = chain_of.at(rpo.front());
+    while (true) {
+        is_placed[next] = true;
+        order.insert(order.end(), chains[next].begin(), chains[next].end());
+
+        for (auto bb : chains[next]) {
+            for (auto succ : bb->GetSuccessors()) {
+                auto idx = chain_of.at(succ);
+                if (is_placed[idx] || chains[idx].front() != succ) {
+                    continue;
+                }
+                incoming[idx] += freq->GetEdgeFrequency(bb, succ);
+                heads.emplace(incoming[idx], idx);
+            }
+        }
+
+        while (!heads.empty() && is_outdated(heads.top())) {
+            heads.pop();
+        }
+        if (heads.empty()) {
+            break;
+        }
+        next = heads.top().second;
+        heads.pop();
+    }
+
+    return order;
+}
+
 void LinearOrder::ProcessLast(BasicBlock* bb)
 {
     if (bb == nullptr) {
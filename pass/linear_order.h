@@ -7,6 +7,9 @@
 
 class BasicBlock;
 
+// places blocks in hot chains (Pettis-Hansen): edges with the highest BlockFrequency become
+// fall-throughs, conditions are inverted to make the hot successor follow it's predecessor.
+// frequencies come from the edge profile of the graph or from static heuristics without it
 class LinearOrder : public Pass
 {
   public:
@@ -22,6 +25,7 @@ class LinearOrder : public Pass
 
   private:
     void Linearize();
+    std::vector<BasicBlock*> BuildChainOrder();
     void AppendJump(BasicBlock* bb);
     BasicBlock* InsertJumpBasicBlock(BasicBlock* prev, BasicBlock* next);
     void ProcessSingleSuccessor(BasicBlock* bb, BasicBlock* prev);
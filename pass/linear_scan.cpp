@@ -5,6 +5,8 @@
 #include "ir/inst.h"
 
 #include <algorithm>
+#include <limits>
+#include <unordered_set>
 
 LinearScan::LinearScan(Graph* g) : Pass(g)
 {
@@ -15,12 +17,33 @@ bool LinearScan::Run()
 {
     Init();
     LinearScanRegisterAllocation();
+    FixRematerialization();
     InsertConnectingSpillFills();
     Check();
 
     return true;
 }
 
+// CONST and ADDI of an available value are cheaper to recompute, than to load
+using AvailableMap = std::unordered_map<const InstBase*, unsigned>;
+static constexpr unsigned REMAT_ANYWHERE = std::numeric_limits<unsigned>::max();
+
+// position, until which inst can be recomputed, given the positions, until which values stay
+// available. 0 if inst is not recomputed
+static unsigned GetRematEnd(const InstBase* inst, const AvailableMap& available)
+{
+    switch (inst->GetOpcode()) {
+    case isa::inst::Opcode::CONST:
+        return REMAT_ANYWHERE;
+    case isa::inst::Opcode::ADDI: {
+        auto it = available.find(inst->GetInput(0).GetInst());
+        return (it == available.end()) ? 0 : it->second;
+    }
+    default:
+        return 0;
+    }
+}
+
 void LinearScan::Init()
 {
     current_stack_slot = 0;
@@ -30,6 +53,9 @@ void LinearScan::Init()
 
     std::fill(reg_map_.begin(), reg_map_.end(), false);
 
+    // frequencies are calculated before liveness, which may insert jump blocks into the graph
+    auto freq = graph_->GetPassManager()->GetValidPass<BlockFrequency>();
+
     for (const auto& e :
          graph_->GetPassManager()->GetValidPass<LivenessAnalysis>()->GetInstLiveRanges()) {
         if (!e.first->HasFlag<isa::flag::Type::NO_USE>()) {
@@ -37,9 +63,79 @@ void LinearScan::Init()
         }
     }
 
+    // live ranges come from unordered map, so ranges with the same start are ordered by id to
+    // keep allocation deterministic
     std::sort(ranges_.begin(), ranges_.end(), [](const LiveRange& l, const LiveRange& r) {
-        return l.range.GetStart() < r.range.GetStart();
+        if (l.range.GetStart() != r.range.GetStart()) {
+            return l.range.GetStart() < r.range.GetStart();
+        }
+        return l.inst->GetId() < r.inst->GetId();
     });
+
+    MarkRematerializable();
+    CalculateSpillWeights(freq);
+}
+
+// value stays available until the end of it's range, if it is kept on register, or until it may
+// be recomputed. ranges are sorted by start, so input of ADDI is visited before it
+void LinearScan::MarkRematerializable()
+{
+    AvailableMap available{};
+    for (auto& r : ranges_) {
+        auto end = r.range.GetEnd();
+        auto remat_end = GetRematEnd(r.inst, available);
+        r.rematerializable = remat_end >= end;
+        available[r.inst] = r.rematerializable ? remat_end : end;
+    }
+}
+
+// spilled value is stored after it's definition and loaded before each use, phi inputs are
+// moved at the end of the source block
+void LinearScan::CalculateSpillWeights(const BlockFrequency* freq)
+{
+    for (auto& r : ranges_) {
+        // recomputation is not more expensive, than a load, and needs no store
+        if (r.rematerializable) {
+            r.spill_weight = 0.0;
+            continue;
+        }
+
+        auto weight = freq->GetFrequency(r.inst->GetBasicBlock());
+
+        std::unordered_set<InstBase*> phis{};
+        for (const auto& user : r.inst->GetUsers()) {
+            auto user_inst = user.GetInst();
+            if (!user_inst->IsPhi()) {
+                weight += freq->GetFrequency(user_inst->GetBasicBlock());
+                continue;
+            }
+
+            if (!phis.insert(user_inst).second) {
+                continue;
+            }
+            auto sources = user_inst->GetPhiSources();
+            for (unsigned i = 0; i < sources.size(); ++i) {
+                if (user_inst->GetInputInsts()[i] == r.inst) {
+                    weight += freq->GetFrequency(sources[i]);
+                }
+            }
+        }
+
+        r.spill_weight = weight;
+    }
+}
+
+// range with lower weight is cheaper to spill, among equal ones the longer range frees register
+// for longer time
+static bool IsCheaperToSpill(const LinearScan::LiveRange* l, const LinearScan::LiveRange* r)
+{
+    if (l->spill_weight < r->spill_weight) {
+        return true;
+    }
+    if (r->spill_weight < l->spill_weight) {
+        return false;
+    }
+    return l->range.GetEnd() > r->range.GetEnd();
 }
 
 void LinearScan::LinearScanRegisterAllocation()
@@ -55,6 +151,33 @@ void LinearScan::LinearScanRegisterAllocation()
     }
 }
 
+// ADDI can be recomputed only if it's input is available at all uses of ADDI, otherwise it is
+// spilled to stack. input on register is available until the end of it's range, recomputed input
+// until it's own input is. ranges are sorted by start, so input location is final, when ADDI is
+// visited
+void LinearScan::FixRematerialization()
+{
+    AvailableMap available{};
+    for (auto& r : ranges_) {
+        auto loc = r.inst->GetLocation();
+        if (loc.IsOnRegister()) {
+            available[r.inst] = r.range.GetEnd();
+            continue;
+        }
+        if (!loc.IsRematerialized()) {
+            continue;
+        }
+
+        auto remat_end = GetRematEnd(r.inst, available);
+        if (remat_end >= r.range.GetEnd()) {
+            available[r.inst] = remat_end;
+            continue;
+        }
+
+        AssignStackSlot(&r);
+    }
+}
+
 static bool IsCriticalEdge(BasicBlock* from, BasicBlock* to)
 {
     return (from->GetNumSuccessors() > 1) && (to->GetNumPredecessors() > 1);
@@ -99,7 +222,7 @@ void LinearScan::InsertConnectingSpillFills()
                 move_bb = FixCriticalEdge(graph_, phi, input_idx);
             }
 
-            move_map_[move_bb].emplace_back(input->GetLocation(), phi->GetLocation());
+            move_map_[move_bb].push_back({ input, input->GetLocation(), phi->GetLocation() });
 
             ++input_idx;
         }
@@ -126,16 +249,32 @@ void LinearScan::SpillAtInterval(LiveRange* r)
 {
     ASSERT(r != nullptr);
 
-    if (active_.back()->range.GetEnd() > r->range.GetEnd()) {
-        ASSERT(active_.back()->inst->GetLocation().IsOnRegister());
-        auto slot = AssignStackSlot(active_.back());
-        ASSERT(active_.back()->inst->GetLocation().IsOnStack());
+    // the cheapest of active ranges and r is spilled
+    auto victim = std::min_element(active_.begin(), active_.end(), IsCheaperToSpill);
+    if (IsCheaperToSpill(*victim, r)) {
+        ASSERT((*victim)->inst->GetLocation().IsOnRegister());
+        auto slot = Spill(*victim);
+        ASSERT(!(*victim)->inst->GetLocation().IsOnRegister());
         r->inst->SetLocation(Location::Where::REGISTER, slot);
-        active_.pop_back();
+        active_.erase(victim);
         AddToActive(r);
     } else {
-        AssignStackSlot(r);
+        Spill(r);
+    }
+}
+
+// returns register, that was used by r
+unsigned LinearScan::Spill(LiveRange* r)
+{
+    ASSERT(r != nullptr);
+
+    if (!r->rematerializable) {
+        return AssignStackSlot(r);
     }
+
+    auto prev_slot = r->inst->GetLocation().slot;
+    r->inst->SetLocation(Location::Where::REMAT, 0);
+    return prev_slot;
 }
 
 unsigned LinearScan::AssignStackSlot(LiveRange* r)
@@ -203,13 +342,13 @@ void LinearScan::Check() const
                     moves = move_map_.at(bb_input);
                 }
 
-                auto it = std::find_if(moves.begin(), moves.end(), [input](const auto& pair) {
-                    return pair.first == input->GetLocation();
+                // rematerialized values share the location, so moves are matched by the value
+                auto it = std::find_if(moves.begin(), moves.end(), [input, phi](const Move& m) {
+                    return m.input == input && m.to == phi->GetLocation();
                 });
 
                 if (it != moves.end()) {
-                    ASSERT(input->GetLocation() == it->first);
-                    ASSERT(phi->GetLocation() == it->second);
+                    ASSERT(input->GetLocation() == it->from);
                 } else {
                     ASSERT(phi->GetLocation() == input->GetLocation());
                 }
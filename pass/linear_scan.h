@@ -2,6 +2,7 @@
 #define __REGALLOC_LINEAR_SCAN_H_INCLUDED__
 
 #include "arch/arch_info.h"
+#include "block_frequency.h"
 #include "ir/inst.h"
 #include "liveness_analysis.h"
 #include "pass.h"
@@ -25,6 +26,19 @@ class LinearScan : public Pass
 
         Range range;
         InstBase* inst;
+        // frequency weighted number of loads and stores, needed if the value is spilled
+        double spill_weight{ 0.0 };
+        // value can be recomputed at all uses instead of spilling
+        bool rematerializable{ false };
+    };
+
+    // insert move of input from `from` to `to` at the end of the bb during codegen. input is
+    // recomputed, if it is rematerialized
+    struct Move
+    {
+        InstBase* input{ nullptr };
+        Location from{};
+        Location to{};
     };
 
     LinearScan(Graph* g);
@@ -51,17 +65,19 @@ class LinearScan : public Pass
     void InsertConnectingSpillFills();
     void ExpireOldIntervals(LiveRange* range);
     void SpillAtInterval(LiveRange* r);
+    unsigned Spill(LiveRange* r);
     unsigned AssignStackSlot(LiveRange* r);
+    void FixRematerialization();
     void AssignRegister(LiveRange* r);
     void ReleaseRegister(LiveRange* r);
     void AddToActive(LiveRange* r);
     bool IsRegMapEmpty() const;
     unsigned GetStackSlot();
     void Init();
+    void MarkRematerializable();
+    void CalculateSpillWeights(const BlockFrequency* freq);
     void Check() const;
 
-    // insert move instruction from pair.first to pair.second at the end of the bb during codegen
-    using Move = std::pair<Location, Location>;
     std::unordered_map<BasicBlock*, std::vector<Move> > move_map_{};
 
     std::vector<LiveRange> ranges_{};
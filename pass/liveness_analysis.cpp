@@ -164,9 +164,9 @@ void LivenessAnalysis::CalculateLiveRanges(BasicBlock* bb)
 
         bb_live_sets_.at(bb).erase(i);
 
-        for (const auto& input : i->GetInputs()) {
-            bb_live_sets_.at(bb).insert(input.GetInst());
-            InstAddLiveRange(input.GetInst(), Range(range.GetStart(), i_live_num));
+        for (auto input : i->GetInputInsts()) {
+            bb_live_sets_.at(bb).insert(input);
+            InstAddLiveRange(input, Range(range.GetStart(), i_live_num));
         }
     }
 
@@ -204,9 +204,10 @@ void LivenessAnalysis::CalculateInitialLiveSet(BasicBlock* bb)
         set = Union(set, bb_live_sets_[succ]);
 
         for (auto phi = succ->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
-            for (const auto& input : phi->GetInputs()) {
-                if (input.GetSourceBB()->GetId() == bb->GetId()) {
-                    set.insert(input.GetInst());
+            auto sources = phi->GetPhiSources();
+            for (unsigned i = 0; i < sources.size(); ++i) {
+                if (sources[i]->GetId() == bb->GetId()) {
+                    set.insert(phi->GetInputInsts()[i]);
                 }
             }
         }
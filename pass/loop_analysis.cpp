@@ -205,7 +205,7 @@ void LoopAnalysis::PropagatePhis(BasicBlock* bb, BasicBlock* pred)
             return in.GetSourceBB()->GetId() == bck->GetId();
         });
 
-        if (it != phi->GetInputs().end()) {
+        if (it != inputs.end()) {
             auto bck_input = *it;
             phi->RemoveInput(bck_input);
             bck_input.GetInst()->RemoveUser(User(phi));
@@ -257,6 +257,8 @@ void LoopAnalysis::BuildLoopTree()
 
 void LoopAnalysis::ResetState()
 {
+    // blocks still point to the loops of the previous run
+    graph_->ClearLoops();
     id_to_dfs_idx_.clear();
     loops_.clear();
     InitStartLoop();
@@ -0,0 +1,651 @@
+#include "loop_unrolling.h"
+#include "ir/bb.h"
+#include "ir/graph.h"
+#include "ir/graph_cloner.h"
+#include "ir/loop.h"
+
+#include <algorithm>
+#include <limits>
+
+using IfImmT = isa::inst::Inst<isa::inst::Opcode::IF_IMM>::Type;
+
+// replaces phi input, incoming from bb_old, with inst_new incoming from bb_new
+static void RedirectPhiInput(InstBase* phi, BasicBlock* bb_old, InstBase* inst_new,
+                             BasicBlock* bb_new)
+{
+    ASSERT(phi != nullptr);
+    ASSERT(phi->IsPhi());
+
+    auto inputs = phi->GetInputs();
+    for (const auto& input : inputs) {
+        input.GetInst()->RemoveUser(phi);
+    }
+    phi->ClearInputs();
+
+    for (const auto& input : inputs) {
+        if (input.GetSourceBB() == bb_old) {
+            phi->AddInput(inst_new, bb_new);
+        } else {
+            phi->AddInput(input);
+        }
+    }
+}
+
+// replaces uses of from, that are located outside of the loop, with to
+static void ReplaceUsesOutside(const Loop* loop, InstBase* from, InstBase* to)
+{
+    ASSERT(from != nullptr);
+    ASSERT(to != nullptr);
+
+    for (const auto& user : from->GetUsers()) {
+        auto inst = user.GetInst();
+        if (loop->Contains(inst->GetBasicBlock())) {
+            continue;
+        }
+
+        to->AddUser(user);
+        inst->ReplaceInput(from, to);
+        from->RemoveUser(user);
+    }
+}
+
+// loop continues while iv cond limit holds, iv changes by step each iteration. returns number of
+// body executions or nullopt, if loop is infinite or the number does not fit into int64_t
+static std::optional<int64_t> ComputeConstTripCount(int64_t init, int64_t limit, int64_t step,
+                                                    Conditional::Type cond)
+{
+    static constexpr int64_t MIN = std::numeric_limits<int64_t>::min();
+
+    int64_t dist = 0;
+    if (step == 0 || step == MIN || __builtin_sub_overflow(limit, init, &dist) || dist == MIN) {
+        return std::nullopt;
+    }
+
+    // number of steps to cover dist, rounded up
+    auto steps = [](int64_t d, int64_t s) { return d / s + ((d % s != 0) ? 1 : 0); };
+
+    int64_t count = 0;
+    switch (cond) {
+    case Conditional::Type::L:
+        if (step < 0) {
+            return std::nullopt;
+        }
+        count = (dist <= 0) ? 0 : steps(dist, step);
+        break;
+    case Conditional::Type::LEQ:
+        if (step < 0 || dist == std::numeric_limits<int64_t>::max()) {
+            return std::nullopt;
+        }
+        count = (dist < 0) ? 0 : steps(dist + 1, step);
+        break;
+    case Conditional::Type::G:
+        if (step > 0) {
+            return std::nullopt;
+        }
+        count = (dist >= 0) ? 0 : steps(-dist, -step);
+        break;
+    case Conditional::Type::GEQ:
+        if (step > 0 || dist == MIN + 1) {
+            return std::nullopt;
+        }
+        count = (dist > 0) ? 0 : steps(-dist + 1, -step);
+        break;
+    case Conditional::Type::NEQ:
+        if (dist % step != 0 || dist / step < 0) {
+            return std::nullopt;
+        }
+        count = dist / step;
+        break;
+    case Conditional::Type::EQ:
+        count = (dist == 0) ? 1 : 0;
+        break;
+    default:
+        return std::nullopt;
+    }
+
+    // iv is init + count * step, when the loop exits. if it wraps, loop doesn't exit there
+    int64_t last = 0;
+    if (__builtin_mul_overflow(count, step, &last) || __builtin_add_overflow(init, last, &last)) {
+        return std::nullopt;
+    }
+
+    return count;
+}
+
+// value of the limit, if it is known at compile time
+static std::optional<int64_t> GetConstLimit(const LoopUnrolling::TripCount& trip_count)
+{
+    if (trip_count.limit == nullptr) {
+        return trip_count.limit_imm;
+    }
+    if (trip_count.limit->IsIntegralConst()) {
+        return trip_count.limit->GetIntegralConst();
+    }
+    return std::nullopt;
+}
+
+// iv + (factor - 1) * step cond limit holds iff iv < limit - offset for increasing iv and
+// iv > limit - offset for decreasing one. nullopt if offset doesn't fit into int64_t
+static std::optional<int64_t> GetGuardOffset(const LoopUnrolling::TripCount& trip_count,
+                                             unsigned factor)
+{
+    auto step = trip_count.iv.step;
+
+    int64_t offset = 0;
+    if (__builtin_mul_overflow(static_cast<int64_t>(factor - 1), step, &offset)) {
+        return std::nullopt;
+    }
+
+    // non-strict conditions are turned into strict ones, offset moves towards zero
+    if (trip_count.cond == Conditional::Type::LEQ || trip_count.cond == Conditional::Type::GEQ) {
+        offset -= (step > 0) ? 1 : -1;
+    }
+
+    return offset;
+}
+
+// slot of header's successor, that stays in the loop
+static unsigned GetLoopSlot(const Loop* loop)
+{
+    auto header = loop->GetHeader();
+    return loop->Contains(header->GetSuccessor(Conditional::Branch::FALLTHROUGH))
+               ? Conditional::Branch::FALLTHROUGH
+               : Conditional::Branch::BRANCH_TRUE;
+}
+
+static unsigned GetExitSlot(const Loop* loop)
+{
+    return (GetLoopSlot(loop) == Conditional::Branch::FALLTHROUGH)
+               ? Conditional::Branch::BRANCH_TRUE
+               : Conditional::Branch::FALLTHROUGH;
+}
+
+bool LoopUnrolling::Run()
+{
+    ResetState();
+
+    // trip counts of all candidates are computed before the first transformation invalidates
+    // loop and induction variable analyses
+    CollectCandidates(graph_->GetPassManager()->GetValidPass<LoopAnalysis>()->GetRootLoop());
+
+    // candidates are innermost loops, so unrolling one of them does not affect the others
+    for (const auto& candidate : candidates_) {
+        if (!TryFullUnroll(candidate)) {
+            TryPartialUnroll(candidate);
+        }
+    }
+
+    return true;
+}
+
+void LoopUnrolling::CollectCandidates(Loop* loop)
+{
+    ASSERT(loop != nullptr);
+
+    for (auto inner : loop->GetInnerLoops()) {
+        CollectCandidates(inner);
+    }
+
+    if (!loop->GetInnerLoops().empty()) {
+        return;
+    }
+
+    auto trip_count = ComputeTripCount(loop);
+    if (trip_count.has_value()) {
+        candidates_.push_back(Candidate{ loop, trip_count.value(), GetLoopSize(loop) });
+    }
+}
+
+bool LoopUnrolling::HasSupportedShape(Loop* loop) const
+{
+    ASSERT(loop != nullptr);
+
+    if (loop->IsRoot() || !loop->IsReducible() || !loop->GetInnerLoops().empty() ||
+        loop->GetPreHeader() == nullptr || loop->GetBackEdges().size() != 1 ||
+        loop->GetBlocks().empty()) {
+        return false;
+    }
+
+    auto header = loop->GetHeader();
+    auto cmp = header->GetLastInst();
+    if (cmp == nullptr || (cmp->GetOpcode() != isa::inst::Opcode::IF &&
+                           cmp->GetOpcode() != isa::inst::Opcode::IF_IMM)) {
+        return false;
+    }
+
+    // header is the only exiting block
+    auto in_loop = header->GetSuccessor(GetLoopSlot(loop));
+    auto exit = header->GetSuccessor(GetExitSlot(loop));
+    if (!loop->Contains(in_loop) || loop->Contains(exit) || in_loop == header) {
+        return false;
+    }
+
+    for (auto bb : loop->GetBlocks()) {
+        for (auto succ : bb->GetSuccessors()) {
+            if (!loop->Contains(succ)) {
+                return false;
+            }
+        }
+    }
+
+    for (auto phi = header->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        if (phi->GetNumInputs() != 2) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::optional<LoopUnrolling::TripCount> LoopUnrolling::ComputeTripCount(Loop* loop)
+{
+    ASSERT(loop != nullptr);
+
+    if (!HasSupportedShape(loop)) {
+        return std::nullopt;
+    }
+
+    auto iv_analysis = graph_->GetPassManager()->GetValidPass<InductionVariableAnalysis>();
+
+    auto cmp = loop->GetHeader()->GetLastInst();
+    auto cond = (cmp->GetOpcode() == isa::inst::Opcode::IF)
+                    ? static_cast<isa::inst_type::IF*>(cmp)->GetCondition()
+                    : static_cast<IfImmT*>(cmp)->GetCondition();
+
+    TripCount res{};
+
+    unsigned iv_idx = 0;
+    auto iv = iv_analysis->GetBasicInductionVariable(cmp->GetInput(0).GetInst());
+    if (iv == nullptr && cmp->GetOpcode() == isa::inst::Opcode::IF) {
+        iv_idx = 1;
+        iv = iv_analysis->GetBasicInductionVariable(cmp->GetInput(1).GetInst());
+        cond = Conditional::Swap(cond);
+    }
+
+    if (iv == nullptr || iv->loop != loop || iv->step == 0) {
+        return std::nullopt;
+    }
+
+    res.iv = *iv;
+
+    std::optional<int64_t> limit_val{};
+    if (cmp->GetOpcode() == isa::inst::Opcode::IF_IMM) {
+        auto imm = static_cast<IfImmT*>(cmp)->GetIntegralImm(0);
+        if (!imm.has_value()) {
+            return std::nullopt;
+        }
+        res.limit_imm = *imm;
+        limit_val = res.limit_imm;
+    } else {
+        res.limit = cmp->GetInput(1 - iv_idx).GetInst();
+        if (loop->Contains(res.limit->GetBasicBlock())) {
+            return std::nullopt;
+        }
+        if (res.limit->IsIntegralConst()) {
+            limit_val = res.limit->GetIntegralConst();
+        }
+    }
+
+    // loop continues by the fallthrough edge if condition does not hold
+    res.cond = (GetLoopSlot(loop) == Conditional::Branch::BRANCH_TRUE)
+                   ? cond
+                   : Conditional::Inverse(cond);
+
+    if (limit_val.has_value() && iv->init->IsIntegralConst()) {
+        auto init = iv->init->GetIntegralConst();
+        auto count = ComputeConstTripCount(init, limit_val.value(), iv->step, res.cond);
+        if (count.has_value()) {
+            res.is_const = true;
+            res.count = count.value();
+        }
+    }
+
+    return res;
+}
+
+// number of instructions, executed in one iteration
+size_t LoopUnrolling::GetLoopSize(Loop* loop) const
+{
+    size_t size = 0;
+
+    auto header = loop->GetHeader();
+    auto last = header->GetLastInst();
+    for (auto inst = header->GetFirstInst(); inst != last; inst = inst->GetNext()) {
+        ++size;
+    }
+
+    for (auto bb : loop->GetBlocks()) {
+        for (auto inst = bb->GetFirstPhi(); inst != nullptr; inst = inst->GetNext()) {
+            ++size;
+        }
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            ++size;
+        }
+    }
+
+    return std::max(size, size_t{ 1 });
+}
+
+bool LoopUnrolling::TryFullUnroll(const Candidate& candidate)
+{
+    const auto& trip_count = candidate.trip_count;
+    if (!trip_count.is_const || trip_count.count > FULL_UNROLL_MAX_TRIP_COUNT) {
+        return false;
+    }
+
+    auto size = static_cast<size_t>(trip_count.count) * candidate.size;
+    if (size > FULL_UNROLL_BUDGET || growth_ + size > GRAPH_GROWTH_BUDGET) {
+        return false;
+    }
+
+    FullUnroll(candidate);
+    growth_ += size;
+
+    return true;
+}
+
+bool LoopUnrolling::TryPartialUnroll(const Candidate& candidate)
+{
+    const auto& trip_count = candidate.trip_count;
+
+    // guard iv + (factor - 1) * step cond limit is only valid for monotonic conditions
+    auto step = trip_count.iv.step;
+    bool is_increasing = (trip_count.cond == Conditional::Type::L ||
+                          trip_count.cond == Conditional::Type::LEQ) &&
+                         step > 0;
+    bool is_decreasing = (trip_count.cond == Conditional::Type::G ||
+                          trip_count.cond == Conditional::Type::GEQ) &&
+                         step < 0;
+    if (!is_increasing && !is_decreasing) {
+        return false;
+    }
+
+    auto factor = static_cast<unsigned>(
+        std::min(size_t{ PARTIAL_UNROLL_MAX_FACTOR }, PARTIAL_UNROLL_BUDGET / candidate.size));
+    if (trip_count.is_const) {
+        factor = static_cast<unsigned>(std::min(int64_t{ factor }, trip_count.count));
+    }
+
+    if (factor < 2) {
+        return false;
+    }
+
+    auto offset = GetGuardOffset(trip_count, factor);
+    if (!offset.has_value()) {
+        return false;
+    }
+
+    // constant bound is folded, main loop is never entered if it doesn't fit into int64_t
+    auto limit = GetConstLimit(trip_count);
+    int64_t bound = 0;
+    if (limit.has_value() && __builtin_sub_overflow(limit.value(), offset.value(), &bound)) {
+        return false;
+    }
+
+    auto size = factor * candidate.size;
+    if (growth_ + size > GRAPH_GROWTH_BUDGET) {
+        return false;
+    }
+
+    PartialUnroll(candidate, factor, offset.value());
+    growth_ += size;
+
+    return true;
+}
+
+// pre_header -> header_1 -> body_1 -> ... -> header_n -> body_n -> header_last -> exit
+void LoopUnrolling::FullUnroll(const Candidate& candidate)
+{
+    auto loop = candidate.loop;
+    auto header = loop->GetHeader();
+    auto pre_header = loop->GetPreHeader();
+    auto back_edge = loop->GetBackEdges().front();
+    auto exit = header->GetSuccessor(GetExitSlot(loop));
+
+    std::unordered_map<InstBase*, InstBase*> phi_values{};
+    for (auto phi = header->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        phi_values[phi] = phi->GetPhiInput(pre_header);
+    }
+
+    BasicBlock* entry = nullptr;
+    // cloned latch jumps to the cloned header of the same iteration
+    BasicBlock* latch = nullptr;
+    BasicBlock* latch_header = nullptr;
+
+    for (int64_t i = 0; i < candidate.trip_count.count; ++i) {
+        GraphCloner cloner{ graph_ };
+        auto clone_header = CloneIteration(loop, phi_values, &cloner, false);
+        if (entry == nullptr) {
+            entry = clone_header;
+        } else {
+            graph_->ReplaceSuccessor(latch, latch_header, clone_header);
+        }
+
+        phi_values = GetNextPhiValues(loop, cloner);
+        latch = cloner.GetClone(back_edge);
+        latch_header = clone_header;
+    }
+
+    // last header execution, that leaves the loop
+    GraphCloner last{ graph_ };
+    auto last_header = CloneIteration(loop, phi_values, &last, true);
+    if (entry == nullptr) {
+        entry = last_header;
+    } else {
+        graph_->ReplaceSuccessor(latch, latch_header, last_header);
+    }
+
+    graph_->ReplaceSuccessor(pre_header, header, entry);
+    graph_->AddEdge(last_header, exit, Conditional::Branch::FALLTHROUGH);
+
+    for (auto phi = exit->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        RedirectPhiInput(phi, header, last.GetClone(phi->GetPhiInput(header)), last_header);
+    }
+
+    // only header values are available outside of the loop
+    for (auto phi = header->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        ReplaceUsesOutside(loop, phi, last.GetClone(phi));
+    }
+    for (auto inst = header->GetFirstInst(); inst != header->GetLastInst();
+         inst = inst->GetNext()) {
+        ReplaceUsesOutside(loop, inst, last.GetClone(inst));
+    }
+
+    RemoveLoop(loop);
+}
+
+// pre_header -> main_header -> header_1 -> body_1 -> ... -> body_factor -> main_header
+//                    |
+//                    v
+//                  header (original loop executes remaining iterations) -> exit
+void LoopUnrolling::PartialUnroll(const Candidate& candidate, unsigned factor, int64_t offset)
+{
+    auto loop = candidate.loop;
+    auto header = loop->GetHeader();
+    auto pre_header = loop->GetPreHeader();
+    auto back_edge = loop->GetBackEdges().front();
+    const auto& trip_count = candidate.trip_count;
+
+    auto main_header = graph_->NewBasicBlock();
+
+    std::unordered_map<InstBase*, InstBase*> phi_values{};
+    std::vector<std::pair<InstBase*, InstBase*> > phis{};
+    for (auto phi = header->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        auto main_phi = phi->Clone();
+        phi_values[phi] = main_phi.get();
+        phis.emplace_back(phi, main_phi.get());
+        main_header->PushBackPhi(std::move(main_phi));
+    }
+
+    // main loop continues only if factor iterations are left. iv is compared with the bound
+    // directly, so the guard doesn't wrap near the ends of int64_t
+    auto iv = trip_count.iv.phi;
+    bool is_increasing = trip_count.iv.step > 0;
+    auto bound = GetGuardBound(candidate, offset);
+
+    auto cmp = header->GetLastInst();
+    main_header->PushBackInst(
+        InstBase::NewInst<isa::inst::Opcode::IF>(is_increasing ? Conditional::Type::L
+                                                               : Conditional::Type::G));
+    auto guard = main_header->GetLastInst();
+    guard->SetDataType(cmp->GetDataType());
+    guard->SetInput(0, phi_values.at(iv));
+    guard->SetInput(1, bound);
+
+    BasicBlock* latch = nullptr;
+    BasicBlock* latch_header = nullptr;
+
+    for (unsigned i = 0; i < factor; ++i) {
+        GraphCloner cloner{ graph_ };
+        auto clone_header = CloneIteration(loop, phi_values, &cloner, false);
+        if (latch == nullptr) {
+            graph_->AddEdge(main_header, clone_header, GetLoopSlot(loop));
+        } else {
+            graph_->ReplaceSuccessor(latch, latch_header, clone_header);
+        }
+
+        phi_values = GetNextPhiValues(loop, cloner);
+        latch = cloner.GetClone(back_edge);
+        latch_header = clone_header;
+    }
+
+    graph_->ReplaceSuccessor(latch, latch_header, main_header);
+    graph_->AddEdge(main_header, header, GetExitSlot(loop));
+    graph_->ReplaceSuccessor(pre_header, header, main_header);
+
+    for (const auto& [phi, main_phi] : phis) {
+        main_phi->AddInput(phi->GetPhiInput(pre_header), pre_header);
+        main_phi->AddInput(phi_values.at(phi), latch);
+        RedirectPhiInput(phi, pre_header, main_phi, main_header);
+    }
+}
+
+// limit - offset, computed in the pre-header, if limit is not a constant. limit is clamped, so
+// the bound saturates at the end of int64_t instead of wrapping
+InstBase* LoopUnrolling::GetGuardBound(const Candidate& candidate, int64_t offset)
+{
+    const auto& trip_count = candidate.trip_count;
+
+    auto limit = GetConstLimit(trip_count);
+    if (limit.has_value()) {
+        // overflow is rejected by TryPartialUnroll
+        return NewIntegralConst(limit.value() - offset);
+    }
+
+    if (offset == 0) {
+        return trip_count.limit;
+    }
+
+    auto pre_header = candidate.loop->GetPreHeader();
+    auto type = trip_count.iv.phi->GetDataType();
+    bool is_increasing = trip_count.iv.step > 0;
+
+    // increasing: max(limit, MIN + offset) - offset, decreasing: min(limit, MAX + offset) - offset
+    auto edge = is_increasing ? std::numeric_limits<int64_t>::min()
+                              : std::numeric_limits<int64_t>::max();
+    auto clamp = is_increasing ? InstBase::NewInst<isa::inst::Opcode::MAX>()
+                               : InstBase::NewInst<isa::inst::Opcode::MIN>();
+    clamp->SetDataType(type);
+    clamp->SetInput(0, trip_count.limit);
+    clamp->SetInput(1, NewIntegralConst(edge + offset));
+
+    auto bound = InstBase::NewInst<isa::inst::Opcode::SUB>();
+    bound->SetDataType(type);
+    bound->SetInput(0, clamp.get());
+    bound->SetInput(1, NewIntegralConst(offset));
+
+    auto res = bound.get();
+    pre_header->InsertInstBeforeTerminator(std::move(clamp));
+    pre_header->InsertInstBeforeTerminator(std::move(bound));
+    return res;
+}
+
+InstBase* LoopUnrolling::NewIntegralConst(int64_t val)
+{
+    graph_->GetStartBasicBlock()->PushBackInst(InstBase::NewInst<isa::inst::Opcode::CONST>(val));
+    return graph_->GetStartBasicBlock()->GetLastInst();
+}
+
+// clones header without exit condition and, unless header_only is set, body of the loop.
+// header phis are replaced with phi_values. returns cloned header
+BasicBlock* LoopUnrolling::CloneIteration(
+    Loop* loop, const std::unordered_map<InstBase*, InstBase*>& phi_values, GraphCloner* cloner,
+    bool header_only)
+{
+    auto header = loop->GetHeader();
+
+    for (const auto& [phi, value] : phi_values) {
+        cloner->MapValue(phi, value);
+    }
+    cloner->Skip(header->GetLastInst());
+
+    std::vector<BasicBlock*> blocks{ header };
+    if (!header_only) {
+        auto body = loop->GetBlocks();
+        blocks.insert(blocks.end(), body.begin(), body.end());
+    }
+    cloner->CloneBlocks(blocks);
+
+    auto clone_header = cloner->GetClone(header);
+    if (!header_only) {
+        auto body_entry = header->GetSuccessor(GetLoopSlot(loop));
+        graph_->AddEdge(clone_header, cloner->GetClone(body_entry),
+                        Conditional::Branch::FALLTHROUGH);
+    }
+
+    return clone_header;
+}
+
+// values of header phis at the beginning of the next iteration
+std::unordered_map<InstBase*, InstBase*> LoopUnrolling::GetNextPhiValues(
+    Loop* loop, const GraphCloner& cloner) const
+{
+    auto header = loop->GetHeader();
+    auto back_edge = loop->GetBackEdges().front();
+
+    std::unordered_map<InstBase*, InstBase*> res{};
+    for (auto phi = header->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        res[phi] = cloner.GetClone(phi->GetPhiInput(back_edge));
+    }
+
+    return res;
+}
+
+// loop should be disconnected from the pre-header and have no users outside
+void LoopUnrolling::RemoveLoop(Loop* loop)
+{
+    std::vector<BasicBlock*> blocks{ loop->GetHeader() };
+    auto body = loop->GetBlocks();
+    blocks.insert(blocks.end(), body.begin(), body.end());
+
+    for (auto bb : blocks) {
+        for (auto inst = bb->GetFirstPhi(); inst != nullptr; inst = inst->GetNext()) {
+            for (auto input : inst->GetInputInsts()) {
+                input->RemoveUser(inst);
+            }
+        }
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            for (auto input : inst->GetInputInsts()) {
+                input->RemoveUser(inst);
+            }
+        }
+    }
+
+    for (auto bb : blocks) {
+        auto succs = bb->GetSuccessors();
+        // successors are removed starting from the last slot to keep the rest of them valid
+        for (auto it = succs.rbegin(); it != succs.rend(); ++it) {
+            graph_->ReplaceSuccessor(bb, *it, nullptr);
+        }
+    }
+
+    for (auto bb : blocks) {
+        graph_->DestroyBasicBlock(bb);
+    }
+}
+
+void LoopUnrolling::ResetState()
+{
+    candidates_.clear();
+    growth_ = 0;
+}
@@ -0,0 +1,107 @@
+#ifndef __PASS_LOOP_UNROLLING_INCLUDED__
+#define __PASS_LOOP_UNROLLING_INCLUDED__
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "induction_variable_analysis.h"
+#include "ir/inst.h"
+#include "pass.h"
+
+class BasicBlock;
+class GraphCloner;
+class Loop;
+
+// unrolls innermost reducible loops of the form:
+//
+// pre_header:
+//   ...
+// header:                      <- exiting block, contains exit condition on basic iv
+//   i = PHI(i0, i1)
+//   ...
+//   IF_IMM i, N / IF i, N
+// body:                        <- all other blocks, single latch
+//   ...
+//   i1 = ADDI i, s
+//
+// loops with small constant trip count are unrolled completely. other loops are unrolled by a
+// factor, remaining iterations are executed by the original loop:
+//
+// pre_header:
+//   bound = N - (factor - 1) * s, clamped not to wrap
+// main_header:
+//   im = PHI(i0, iu)
+//   IF im, bound               -> original header
+// header_1, body_1, ..., header_factor, body_factor -> main_header
+class LoopUnrolling : public Pass
+{
+  public:
+    // loop executes it's body while iv cond limit holds
+    struct TripCount
+    {
+        InductionVariableAnalysis::BasicInductionVariable iv{};
+        Conditional::Type cond{ Conditional::Type::UNSET };
+        // nullptr if limit is an immediate
+        InstBase* limit{ nullptr };
+        int64_t limit_imm{ 0 };
+        // number of body executions, valid only if is_const is set
+        bool is_const{ false };
+        int64_t count{ 0 };
+    };
+
+    // maximum trip count of completely unrolled loop
+    static constexpr int64_t FULL_UNROLL_MAX_TRIP_COUNT = 16;
+    // maximum number of instructions in completely unrolled loop
+    static constexpr size_t FULL_UNROLL_BUDGET = 128;
+    static constexpr unsigned PARTIAL_UNROLL_MAX_FACTOR = 4;
+    // maximum number of instructions in partially unrolled loop body
+    static constexpr size_t PARTIAL_UNROLL_BUDGET = 64;
+    // maximum number of instructions added to the graph by the pass
+    static constexpr size_t GRAPH_GROWTH_BUDGET = 512;
+
+    LoopUnrolling(Graph* graph) : Pass(graph)
+    {
+    }
+
+    NO_COPY_SEMANTIC(LoopUnrolling);
+    NO_MOVE_SEMANTIC(LoopUnrolling);
+
+    bool Run() override;
+
+    // nullopt if loop has unsupported shape or exit condition
+    std::optional<TripCount> ComputeTripCount(Loop* loop);
+
+  private:
+    struct Candidate
+    {
+        Loop* loop{ nullptr };
+        TripCount trip_count{};
+        size_t size{ 0 };
+    };
+
+    void CollectCandidates(Loop* loop);
+    bool HasSupportedShape(Loop* loop) const;
+    size_t GetLoopSize(Loop* loop) const;
+
+    bool TryFullUnroll(const Candidate& candidate);
+    bool TryPartialUnroll(const Candidate& candidate);
+    void FullUnroll(const Candidate& candidate);
+    void PartialUnroll(const Candidate& candidate, unsigned factor, int64_t offset);
+    InstBase* GetGuardBound(const Candidate& candidate, int64_t offset);
+    InstBase* NewIntegralConst(int64_t val);
+
+    BasicBlock* CloneIteration(Loop* loop,
+                               const std::unordered_map<InstBase*, InstBase*>& phi_values,
+                               GraphCloner* cloner, bool header_only);
+    std::unordered_map<InstBase*, InstBase*> GetNextPhiValues(Loop* loop,
+                                                              const GraphCloner& cloner) const;
+    void RemoveLoop(Loop* loop);
+    void ResetState();
+
+    std::vector<Candidate> candidates_{};
+    size_t growth_{ 0 };
+};
+
+#endif
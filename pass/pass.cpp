@@ -0,0 +1,10 @@
+#include "pass.h"
+#include "ir/inst.h"
+
+void Pass::TransferUsers(InstBase* from, InstBase* to)
+{
+    ASSERT(from != nullptr);
+    ASSERT(to != nullptr);
+
+    from->ReplaceUsers(to);
+}
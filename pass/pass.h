@@ -1,12 +1,14 @@
 #ifndef __PASS_H_INCLUDED__
 #define __PASS_H_INCLUDED__
 
+#include "ir/typedefs.h"
 #include "utils/macros.h"
 #include "utils/type_helpers.h"
 
 #include <memory>
 
 class Graph;
+class InstBase;
 
 class Pass
 {
@@ -40,6 +42,9 @@ class Pass
     virtual bool Run() = 0;
 
   protected:
+    // users of from are redirected to to
+    void TransferUsers(InstBase* from, InstBase* to);
+
     Graph* graph_;
 
     bool is_valid_ = false;
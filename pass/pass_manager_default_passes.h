@@ -4,21 +4,31 @@
 #include "pass_list.h"
 
 #include "bfs.h"
+#include "block_frequency.h"
 #include "check_elimination.h"
 #include "dbe.h"
 #include "dce.h"
 #include "dfs.h"
 #include "dom_tree.h"
+#include "dominance_frontier.h"
+#include "induction_variable_analysis.h"
 #include "inlining.h"
+#include "jump_threading.h"
 #include "linear_order.h"
 #include "linear_scan.h"
 #include "liveness_analysis.h"
 #include "loop_analysis.h"
+#include "loop_unrolling.h"
 #include "peepholes.h"
 #include "po.h"
 #include "rpo.h"
+#include "simplify_cfg.h"
+#include "strength_reduction.h"
 
-using DefaultPasses = PassList<DomTree, LoopAnalysis, DFS, BFS, RPO, PO, Peepholes, DCE, Inlining,
-                               DBE, CheckElimination, LinearOrder, LivenessAnalysis, LinearScan>;
+using DefaultPasses =
+    PassList<DomTree, DominanceFrontier, LoopAnalysis, InductionVariableAnalysis, BlockFrequency,
+             DFS, BFS, RPO, PO, Peepholes, DCE, Inlining, DBE, JumpThreading, SimplifyCFG,
+             CheckElimination, StrengthReduction, LoopUnrolling, LinearOrder, LivenessAnalysis,
+             LinearScan>;
 
 #endif
\ No newline at end of file
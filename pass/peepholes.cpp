@@ -72,7 +72,10 @@ static bool FoldBinOpToBinImmOp(InstBase* i)
     return true;
 }
 
-GEN_DEFAULT_VISIT_FUNCTIONS(Peepholes, RPO);
+std::vector<BasicBlock*> Peepholes::BlockOrder() const
+{
+    return graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+}
 
 bool Peepholes::Run()
 {
@@ -89,27 +92,24 @@ void Peepholes::ReplaceWithIntegralConst(InstBase* inst, int64_t val)
     TransferUsers(inst, new_inst);
 }
 
-void Peepholes::VisitADD(GraphVisitor* v, InstBase* inst)
+void Peepholes::VisitADD(InstBase* inst)
 {
     ASSERT(inst != nullptr);
     ASSERT(inst->GetOpcode() == isa::inst::Opcode::ADD);
-    ASSERT(v != nullptr);
 
-    auto _this = static_cast<Peepholes*>(v);
-
-    if (_this->FoldADD(inst)) {
+    if (FoldADD(inst)) {
         return;
     }
 
-    if (_this->MatchADD_zero(inst)) {
+    if (MatchADD_zero(inst)) {
         return;
     }
 
-    if (_this->MatchADD_after_sub(inst)) {
+    if (MatchADD_after_sub(inst)) {
         return;
     }
 
-    if (_this->MatchADD_same_value(inst)) {
+    if (MatchADD_same_value(inst)) {
         return;
     }
 
@@ -255,23 +255,20 @@ bool Peepholes::MatchADD_same_value(InstBase* i)
     return false;
 }
 
-void Peepholes::VisitASHR(GraphVisitor* v, InstBase* inst)
+void Peepholes::VisitASHR(InstBase* inst)
 {
     ASSERT(inst != nullptr);
     ASSERT(inst->GetOpcode() == isa::inst::Opcode::ASHR);
-    ASSERT(v != nullptr);
-
-    auto _this = static_cast<Peepholes*>(v);
 
-    if (_this->FoldASHR(inst)) {
+    if (FoldASHR(inst)) {
         return;
     }
 
-    if (_this->MatchASHR_zero_0(inst)) {
+    if (MatchASHR_zero_0(inst)) {
         return;
     }
 
-    if (_this->MatchASHR_zero_1(inst)) {
+    if (MatchASHR_zero_1(inst)) {
         return;
     }
 
@@ -349,22 +346,20 @@ bool Peepholes::MatchASHR_zero_1(InstBase* i)
     return false;
 }
 
-void Peepholes::VisitXOR(GraphVisitor* v, InstBase* inst)
+void Peepholes::VisitXOR(InstBase* inst)
 {
     ASSERT(inst != nullptr);
     ASSERT(inst->GetOpcode() == isa::inst::Opcode::XOR);
-    ASSERT(v != nullptr);
 
-    auto _this = static_cast<Peepholes*>(v);
-    if (_this->FoldXOR(inst)) {
+    if (FoldXOR(inst)) {
         return;
     }
 
-    if (_this->MatchXOR_same_value(inst)) {
+    if (MatchXOR_same_value(inst)) {
         return;
     }
 
-    if (_this->MatchXOR_zero(inst)) {
+    if (MatchXOR_zero(inst)) {
         return;
     }
 
@@ -4,10 +4,12 @@
 #include "ir/graph_visitor.h"
 #include "pass.h"
 
+#include <vector>
+
 class BasicBlock;
 class InstBase;
 
-class Peepholes : public Pass, public GraphVisitor
+class Peepholes : public Pass, public GraphVisitor<Peepholes>
 {
   public:
     Peepholes(Graph* graph) : Pass(graph)
@@ -63,11 +65,13 @@ class Peepholes : public Pass, public GraphVisitor
     bool MatchXOR_zero(InstBase* i);
 
   private:
-    static void VisitADD(GraphVisitor* v, InstBase* inst);
-    static void VisitXOR(GraphVisitor* v, InstBase* inst);
-    static void VisitASHR(GraphVisitor* v, InstBase* inst);
+    friend GraphVisitor<Peepholes>;
+
+    std::vector<BasicBlock*> BlockOrder() const;
 
-#include "ir/graph_visitor.inc"
+    void VisitADD(InstBase* inst);
+    void VisitXOR(InstBase* inst);
+    void VisitASHR(InstBase* inst);
 };
 
 #endif
\ No newline at end of file
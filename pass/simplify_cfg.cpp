@@ -0,0 +1,457 @@
+#include "simplify_cfg.h"
+#include "ir/bb.h"
+#include "ir/graph.h"
+#include "ir/inst.h"
+
+#include <bit>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// inst is removed from it's block, inst itself should have no users
+static void RemoveInst(InstBase* inst)
+{
+    ASSERT(inst->GetNumUsers() == 0);
+
+    for (auto input : inst->GetInputInsts()) {
+        input->RemoveUser(inst);
+    }
+    inst->GetBasicBlock()->UnlinkInst(inst);
+}
+
+// the only value of phi, nullptr if phi merges different values
+static InstBase* GetTrivialPhiValue(InstBase* phi)
+{
+    InstBase* value = nullptr;
+    for (auto inst : phi->GetInputInsts()) {
+        if (inst == phi || inst == value) {
+            continue;
+        }
+        if (value != nullptr) {
+            return nullptr;
+        }
+        value = inst;
+    }
+    return value;
+}
+
+// instructions with the same opcode, type, inputs and attributes compute the same value
+static bool IsSameInst(const InstBase* inst, const InstBase* other)
+{
+    if (inst->GetOpcode() != other->GetOpcode() ||
+        inst->GetDataType() != other->GetDataType()) {
+        return false;
+    }
+
+    ASSERT(!inst->IsDynamic());
+    for (unsigned i = 0; i < inst->GetNumInputs(); ++i) {
+        if (inst->GetInput(i).GetInst() != other->GetInput(i).GetInst()) {
+            return false;
+        }
+    }
+
+    if (inst->IsConst()) {
+        return isa::inst_type::CONST::Compare(inst, other);
+    }
+
+    if (inst->GetNumImms() != 0) {
+        using BinImmT = isa::inst_type::BIN_IMM;
+        auto imm = static_cast<const BinImmT*>(inst)->GetImm(0);
+        auto other_imm = static_cast<const BinImmT*>(other)->GetImm(0);
+        return std::bit_cast<uint64_t>(imm) == std::bit_cast<uint64_t>(other_imm);
+    }
+
+    if (inst->IsConditional()) {
+        using CompareT = isa::inst_type::COMPARE;
+        return static_cast<const CompareT*>(inst)->GetCondition() ==
+               static_cast<const CompareT*>(other)->GetCondition();
+    }
+
+    return true;
+}
+
+// instruction is executed right after the branch on both paths, so it may be executed before it
+static bool CanHoist(const InstBase* inst)
+{
+    return !inst->IsPhi() && !inst->IsDynamic() && !inst->IsParam() &&
+           !inst->HasFlag<isa::flag::Type::BRANCH>();
+}
+
+// empty block with single predecessor, that only passes control to it's successor
+static bool IsForwarder(BasicBlock* bb)
+{
+    auto first = bb->GetFirstInst();
+    return bb->GetFirstPhi() == nullptr && bb->GetNumPredecessors() == 1 &&
+           (first == nullptr || (first->GetNext() == nullptr && first->IsUnconditionalJump()));
+}
+
+// block, where arm of the branch of bb, starting with succ, ends, and it's predecessor on the arm
+static std::pair<BasicBlock*, BasicBlock*> GetArmJoin(BasicBlock* bb, BasicBlock* succ)
+{
+    if (IsForwarder(succ)) {
+        return { succ->GetSuccessor(0), succ };
+    }
+    return { succ, bb };
+}
+
+static Conditional::Branch GetSlot(bool outcome)
+{
+    return outcome ? Conditional::Branch::BRANCH_TRUE : Conditional::Branch::FALLTHROUGH;
+}
+
+bool SimplifyCFG::Run()
+{
+    ResetState();
+
+    // blocks are popped in RPO
+    auto rpo = graph_->GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+    for (auto it = rpo.rbegin(); it != rpo.rend(); ++it) {
+        Enqueue(*it);
+    }
+
+    while (Sweep()) {
+        for (auto bb : graph_->RemoveUnreachableBlocks()) {
+            Revisit(bb);
+        }
+    }
+
+    return true;
+}
+
+bool SimplifyCFG::Sweep()
+{
+    bool cfg_changed = false;
+
+    while (!worklist_.empty()) {
+        auto id = worklist_.back();
+        worklist_.pop_back();
+        queued_.erase(id);
+
+        auto bb = graph_->GetBasicBlock(id);
+        if (bb == nullptr) {
+            continue;
+        }
+
+        RemoveTrivialPhis(bb);
+        HoistCommonInsts(bb);
+
+        std::vector<IdType> succs{};
+        for (auto succ : bb->GetSuccessors()) {
+            if (succ != nullptr) {
+                succs.push_back(succ->GetId());
+            }
+        }
+
+        if (FoldConstantBranch(bb) || ConvertToMinMax(bb) || MergeWithSuccessor(bb)) {
+            cfg_changed = true;
+
+            // former successors may lose predecessors or be merged into bb
+            Revisit(bb);
+            for (auto succ_id : succs) {
+                auto succ = graph_->GetBasicBlock(succ_id);
+                if (succ != nullptr) {
+                    Revisit(succ);
+                }
+            }
+        }
+    }
+
+    return cfg_changed;
+}
+
+void SimplifyCFG::Enqueue(BasicBlock* bb)
+{
+    ASSERT(bb != nullptr);
+
+    if (queued_.insert(bb->GetId()).second) {
+        worklist_.push_back(bb->GetId());
+    }
+}
+
+void SimplifyCFG::Revisit(BasicBlock* bb)
+{
+    for (auto pred : bb->GetPredecessors()) {
+        Enqueue(pred);
+    }
+    for (auto succ : bb->GetSuccessors()) {
+        if (succ != nullptr) {
+            Enqueue(succ);
+        }
+    }
+    // bb is visited first
+    Enqueue(bb);
+}
+
+void SimplifyCFG::ResetState()
+{
+    worklist_.clear();
+    queued_.clear();
+}
+
+void SimplifyCFG::RemoveTrivialPhis(BasicBlock* bb)
+{
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        auto phi = bb->GetFirstPhi();
+        while (phi != nullptr) {
+            auto next = phi->GetNext();
+
+            auto value = GetTrivialPhiValue(phi);
+            if (value != nullptr) {
+                // self-references are dropped together with the rest of the inputs
+                for (auto input : phi->GetInputInsts()) {
+                    input->RemoveUser(phi);
+                }
+                phi->ClearInputs();
+                TransferUsers(phi, value);
+                bb->UnlinkInst(phi);
+                changed = true;
+            }
+
+            phi = next;
+        }
+    }
+}
+
+void SimplifyCFG::HoistCommonInsts(BasicBlock* bb)
+{
+    auto branch = bb->GetLastInst();
+    if (branch == nullptr || bb->GetNumSuccessors() != 2) {
+        return;
+    }
+
+    auto succ_true = bb->GetSuccessor(Conditional::Branch::BRANCH_TRUE);
+    auto succ_false = bb->GetSuccessor(Conditional::Branch::FALLTHROUGH);
+    if (succ_true->GetNumPredecessors() != 1 || succ_false->GetNumPredecessors() != 1) {
+        return;
+    }
+
+    auto inst = succ_true->GetFirstInst();
+    auto other = succ_false->GetFirstInst();
+    while (inst != nullptr && other != nullptr && CanHoist(inst) && IsSameInst(inst, other)) {
+        auto next = inst->GetNext();
+        auto other_next = other->GetNext();
+
+        HoistInst(bb, inst, other);
+
+        inst = next;
+        other = other_next;
+    }
+}
+
+// copy of inst is inserted before the branch of bb, inst and same are replaced with it
+void SimplifyCFG::HoistInst(BasicBlock* bb, InstBase* inst, InstBase* same)
+{
+    auto branch = bb->GetLastInst();
+    bb->InsertInstBefore(inst->Clone(), branch);
+    auto hoisted = branch->GetPrev();
+
+    for (unsigned i = 0; i < inst->GetNumInputs(); ++i) {
+        hoisted->SetInput(i, inst->GetInput(i).GetInst());
+    }
+
+    TransferUsers(inst, hoisted);
+    TransferUsers(same, hoisted);
+    RemoveInst(inst);
+    RemoveInst(same);
+}
+
+bool SimplifyCFG::FoldConstantBranch(BasicBlock* bb)
+{
+    auto branch = bb->GetLastInst();
+    if (branch == nullptr || bb->GetNumSuccessors() != 2) {
+        return false;
+    }
+
+    auto lhs = branch->GetInput(0).GetInst();
+    std::optional<bool> outcome{};
+
+    if (branch->GetOpcode() == isa::inst::Opcode::IF_IMM) {
+        using IfImmT = isa::inst::Inst<isa::inst::Opcode::IF_IMM>::Type;
+        auto if_imm = static_cast<IfImmT*>(branch);
+        auto imm = if_imm->GetIntegralImm(0);
+        if (lhs->IsIntegralConst() && imm.has_value()) {
+            outcome = Conditional::Evaluate(if_imm->GetCondition(), lhs->GetIntegralConst(), *imm);
+        }
+    } else if (branch->GetOpcode() == isa::inst::Opcode::IF) {
+        using IfT = isa::inst::Inst<isa::inst::Opcode::IF>::Type;
+        auto cond = static_cast<IfT*>(branch)->GetCondition();
+        auto rhs = branch->GetInput(1).GetInst();
+        // x cond x is known for integers only, because of NaN
+        if (lhs == rhs && lhs->GetDataType() == InstBase::DataType::INT) {
+            outcome = Conditional::Evaluate(cond, 0, 0);
+        } else if (lhs->IsIntegralConst() && rhs->IsIntegralConst()) {
+            auto lhs_val = lhs->GetIntegralConst();
+            outcome = Conditional::Evaluate(cond, lhs_val, rhs->GetIntegralConst());
+        }
+    }
+
+    if (!outcome.has_value()) {
+        return false;
+    }
+
+    graph_->ReplaceBranchWithJump(bb, bb->GetSuccessor(GetSlot(*outcome)));
+    return true;
+}
+
+bool SimplifyCFG::ConvertToMinMax(BasicBlock* bb)
+{
+    auto branch = bb->GetLastInst();
+    if (branch == nullptr || bb->GetNumSuccessors() != 2 || !branch->IsConditional()) {
+        return false;
+    }
+
+    auto opcode = branch->GetOpcode();
+    if (opcode != isa::inst::Opcode::IF && opcode != isa::inst::Opcode::IF_IMM) {
+        return false;
+    }
+
+    Conditional::Type cond{};
+    InstBase* rhs = nullptr;
+    ImmType imm{};
+    if (opcode == isa::inst::Opcode::IF_IMM) {
+        auto if_imm = static_cast<isa::inst_type::IF_IMM*>(branch);
+        cond = if_imm->GetCondition();
+        imm = if_imm->GetImm(0);
+    } else {
+        cond = static_cast<isa::inst_type::IF*>(branch)->GetCondition();
+        rhs = branch->GetInput(1).GetInst();
+    }
+
+    bool is_less = cond == Conditional::Type::L || cond == Conditional::Type::LEQ;
+    bool is_greater = cond == Conditional::Type::G || cond == Conditional::Type::GEQ;
+    if (!is_less && !is_greater) {
+        return false;
+    }
+
+    auto succ_true = bb->GetSuccessor(Conditional::Branch::BRANCH_TRUE);
+    auto succ_false = bb->GetSuccessor(Conditional::Branch::FALLTHROUGH);
+    auto [join, src_true] = GetArmJoin(bb, succ_true);
+    auto [join_false, src_false] = GetArmJoin(bb, succ_false);
+    if (join != join_false || src_true == src_false || join->GetNumPredecessors() != 2 ||
+        join->GetFirstPhi() == nullptr) {
+        return false;
+    }
+
+    auto lhs = branch->GetInput(0).GetInst();
+    auto is_rhs = [rhs, imm](InstBase* value) {
+        if (rhs != nullptr) {
+            return value == rhs;
+        }
+        return value->IsIntegralConst() && ImmToIntegral(imm) == value->GetIntegralConst();
+    };
+
+    // every phi of join should select lhs on one arm and rhs on the other one. MIN / MAX of
+    // floating point values treat NaN and signed zeros differently from the comparison
+    std::vector<std::pair<InstBase*, bool> > selects{};
+    for (auto phi = join->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        if (phi->GetDataType() != InstBase::DataType::INT) {
+            return false;
+        }
+
+        auto value_true = phi->GetPhiInput(src_true);
+        auto value_false = phi->GetPhiInput(src_false);
+
+        if (value_true == lhs && is_rhs(value_false)) {
+            selects.emplace_back(phi, true);
+        } else if (is_rhs(value_true) && value_false == lhs) {
+            selects.emplace_back(phi, false);
+        } else {
+            return false;
+        }
+    }
+
+    for (auto [phi, lhs_on_true] : selects) {
+        bool is_min = (lhs_on_true == is_less);
+
+        std::unique_ptr<InstBase> select{};
+        if (rhs != nullptr) {
+            select = is_min ? InstBase::NewInst<isa::inst::Opcode::MIN>()
+                            : InstBase::NewInst<isa::inst::Opcode::MAX>();
+        } else {
+            select = is_min ? InstBase::NewInst<isa::inst::Opcode::MINI>()
+                            : InstBase::NewInst<isa::inst::Opcode::MAXI>();
+        }
+        select->SetDataType(phi->GetDataType());
+
+        bb->InsertInstBefore(std::move(select), branch);
+        auto inst = branch->GetPrev();
+        inst->SetInput(0, lhs);
+        if (rhs != nullptr) {
+            inst->SetInput(1, rhs);
+        } else {
+            static_cast<isa::inst_type::BIN_IMM*>(inst)->SetImmediate(0, imm);
+        }
+
+        for (auto input : phi->GetInputInsts()) {
+            input->RemoveUser(phi);
+        }
+        phi->ClearInputs();
+        TransferUsers(phi, inst);
+        join->UnlinkInst(phi);
+    }
+
+    // both arms are empty now
+    graph_->ReplaceBranchWithJump(bb, succ_false);
+    return true;
+}
+
+bool SimplifyCFG::MergeWithSuccessor(BasicBlock* bb)
+{
+    // start block keeps parameters and constants only
+    if (bb->IsStartBlock() || bb->GetNumSuccessors() != 1) {
+        return false;
+    }
+
+    auto succ = bb->GetSuccessor(0);
+    if (succ == nullptr || succ == bb || succ->GetNumPredecessors() != 1) {
+        return false;
+    }
+    ASSERT(!succ->IsStartBlock());
+
+    // phis of succ have the only input
+    for (auto phi = succ->GetFirstPhi(); phi != nullptr; phi = succ->GetFirstPhi()) {
+        ASSERT(phi->GetNumInputs() == 1);
+        auto value = phi->GetInput(0).GetInst();
+        value->RemoveUser(phi);
+        phi->ClearInputs();
+        TransferUsers(phi, value);
+        succ->UnlinkInst(phi);
+    }
+
+    auto last = bb->GetLastInst();
+    if (last != nullptr && last->IsUnconditionalJump()) {
+        bb->UnlinkInst(last);
+    }
+
+    std::vector<BasicBlock*> succs{};
+    for (unsigned slot = 0; slot < succ->GetNumSuccessors(); ++slot) {
+        succs.push_back(succ->GetSuccessor(slot));
+    }
+
+    graph_->ReplaceSuccessor(bb, succ, nullptr);
+    // successors are removed starting from the last slot to keep the rest of them valid
+    for (auto it = succs.rbegin(); it != succs.rend(); ++it) {
+        graph_->ReplaceSuccessor(succ, *it, nullptr);
+    }
+
+    auto succ_last = succ->GetLastInst();
+    auto insts = std::unique_ptr<InstBase>{ succ->TransferInst() };
+    if (insts != nullptr) {
+        bb->PushBackInst(std::move(insts));
+        bb->SetLastInst(succ_last);
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            inst->SetBasicBlock(bb);
+        }
+    }
+
+    for (unsigned slot = 0; slot < succs.size(); ++slot) {
+        graph_->AddEdge(bb, succs[slot], slot);
+        succs[slot]->ReplacePhiSource(succ, bb);
+    }
+
+    graph_->DestroyBasicBlock(succ);
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef __PASS_SIMPLIFY_CFG_INCLUDED__
+#define __PASS_SIMPLIFY_CFG_INCLUDED__
+
+#include <unordered_set>
+#include <vector>
+
+#include "pass.h"
+
+class BasicBlock;
+class InstBase;
+
+// simplifies control flow until nothing changes:
+// - phis with the same input from all predecessors are replaced with the input
+// - IF / IF_IMM with known outcome is replaced with a jump
+// - identical instructions at the beginning of both branch arms are hoisted to the branch
+// - diamond or triangle with empty arms, that selects one of the compared values:
+//
+//   bb:   IF a, b, L   -> t        bb:  m = MIN a, b
+//   t:                             j:
+//   f:                      ->
+//   j:    x = PHI(a from t, b from f)
+//
+//   is replaced with MIN / MAX (MINI / MAXI for IF_IMM), there is no select instruction. only
+//   integer values are selected this way
+// - block is merged with it's only successor, if it is the only predecessor of the successor
+//
+// every block is visited once per sweep, blocks around a change are revisited in the same sweep.
+// blocks, that become unreachable, are removed after the sweep, reachable blocks, that lose
+// predecessors with them, start the next one
+class SimplifyCFG : public Pass
+{
+  public:
+    SimplifyCFG(Graph* graph) : Pass(graph)
+    {
+    }
+
+    NO_COPY_SEMANTIC(SimplifyCFG);
+    NO_MOVE_SEMANTIC(SimplifyCFG);
+
+    bool Run() override;
+
+  private:
+    // returns true if CFG was changed
+    bool Sweep();
+    void Enqueue(BasicBlock* bb);
+    // bb, it's predecessors and successors
+    void Revisit(BasicBlock* bb);
+    void ResetState();
+
+    // transformations, that keep CFG
+    void RemoveTrivialPhis(BasicBlock* bb);
+    void HoistCommonInsts(BasicBlock* bb);
+
+    // transformations, that change CFG
+    bool FoldConstantBranch(BasicBlock* bb);
+    bool ConvertToMinMax(BasicBlock* bb);
+    bool MergeWithSuccessor(BasicBlock* bb);
+
+    void HoistInst(BasicBlock* bb, InstBase* inst, InstBase* same);
+
+    // ids of blocks to visit, blocks may be destroyed while they are queued
+    std::vector<IdType> worklist_{};
+    std::unordered_set<IdType> queued_{};
+};
+
+#endif
@@ -0,0 +1,284 @@
+#include "strength_reduction.h"
+#include "ir/bb.h"
+#include "ir/graph.h"
+#include "ir/loop.h"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+using BinImmT = isa::inst_type::BIN_IMM;
+
+// instruction, that is going to be removed by DCE
+static bool IsDead(const InstBase* inst)
+{
+    return inst->GetNumUsers() == 0 && !inst->HasFlag<isa::flag::Type::NO_DCE>();
+}
+
+// nullopt if the product doesn't fit in int64_t
+static std::optional<int64_t> Multiply(int64_t lhs, int64_t rhs)
+{
+    int64_t res = 0;
+    if (__builtin_mul_overflow(lhs, rhs, &res)) {
+        return std::nullopt;
+    }
+    return res;
+}
+
+// i goes from init towards limit by step and leaves the loop, once it passes the limit, so
+// i and it's update stay between init and limit + step. returns true if i * scale doesn't
+// overflow on them, scale is positive
+static bool IsScaledRangeExact(int64_t init, int64_t limit, int64_t step, int64_t scale)
+{
+    ASSERT(scale > 0);
+
+    if (step == 0 || (step > 0 && init > limit) || (step < 0 && init < limit)) {
+        return false;
+    }
+
+    int64_t bound = 0;
+    if (__builtin_add_overflow(limit, step, &bound)) {
+        return false;
+    }
+    return Multiply(init, scale).has_value() && Multiply(bound, scale).has_value();
+}
+
+static bool IsLoopExit(const Loop* loop, const BasicBlock* bb)
+{
+    const auto& succs = bb->GetSuccessors();
+    return std::any_of(succs.begin(), succs.end(),
+                       [loop](BasicBlock* succ) { return !loop->Contains(succ); });
+}
+
+bool StrengthReduction::Run()
+{
+    ResetState();
+
+    auto pm = graph_->GetPassManager();
+    auto root = pm->GetValidPass<LoopAnalysis>()->GetRootLoop();
+    iv_analysis_ = pm->GetValidPass<InductionVariableAnalysis>();
+
+    for (auto loop : root->GetInnerLoops()) {
+        ProcessLoop(loop);
+    }
+
+    if (changed_) {
+        pm->GetPass<InductionVariableAnalysis>()->SetValid(false);
+    }
+
+    return true;
+}
+
+void StrengthReduction::ProcessLoop(Loop* loop)
+{
+    ASSERT(loop != nullptr);
+
+    for (auto inner : loop->GetInnerLoops()) {
+        ProcessLoop(inner);
+    }
+
+    for (const auto& div : iv_analysis_->GetDerivedInductionVariables(loop)) {
+        ReduceDerived(div);
+    }
+
+    for (const auto& biv : iv_analysis_->GetBasicInductionVariables(loop)) {
+        ReplaceExitCondition(biv);
+    }
+}
+
+void StrengthReduction::ReduceDerived(const DerivedIV& div)
+{
+    // multiplication by 0 or 1 is peepholes' job
+    if (div.scale == 0 || div.scale == 1) {
+        return;
+    }
+
+    auto biv = iv_analysis_->GetBasicInductionVariable(div.base);
+    ASSERT(biv != nullptr);
+
+    auto reduced = GetOrCreateReduced(*biv, div.scale);
+    if (!reduced.has_value()) {
+        return;
+    }
+    TransferUsers(div.inst, reduced->phi);
+
+    changed_ = true;
+}
+
+// nullopt if step * scale or constant initial value * scale overflows, or if step * scale is
+// not an exact immediate
+std::optional<StrengthReduction::ReducedIV> StrengthReduction::GetOrCreateReduced(
+    const BasicIV& biv, int64_t scale)
+{
+    auto key = std::make_pair(biv.phi, scale);
+    if (reduced_.count(key) != 0) {
+        return reduced_.at(key);
+    }
+
+    auto loop = biv.loop;
+    ASSERT(loop->GetBackEdges().size() == 1);
+
+    auto step = Multiply(biv.step, scale);
+    auto step_imm = step.has_value() ? IntegralToImm(*step) : std::nullopt;
+    if (!step_imm.has_value()) {
+        return std::nullopt;
+    }
+    auto init = ScaleInvariant(loop, biv.init, scale);
+    if (init == nullptr) {
+        return std::nullopt;
+    }
+
+    auto header = loop->GetHeader();
+    header->PushBackPhi(InstBase::NewInst<isa::inst::Opcode::PHI>());
+    auto phi = header->GetLastPhi();
+
+    auto update = biv.update->GetBasicBlock();
+    update->InsertInstAfter(InstBase::NewInst<isa::inst::Opcode::ADDI>(), biv.update);
+    auto add = biv.update->GetNext();
+    add->SetInput(0, phi);
+    static_cast<BinImmT*>(add)->SetImmediate(0, *step_imm);
+
+    phi->AddInput(init, loop->GetPreHeader());
+    phi->AddInput(add, loop->GetBackEdges().front());
+
+    reduced_.emplace(key, ReducedIV{ phi, add, scale });
+    return reduced_.at(key);
+}
+
+// returns instruction, that holds value of inst * scale, where inst is loop-invariant.
+// nullptr if inst is constant and the product overflows or if scale is not an exact immediate
+InstBase* StrengthReduction::ScaleInvariant(Loop* loop, InstBase* inst, int64_t scale)
+{
+    ASSERT(inst != nullptr);
+    ASSERT(!loop->Contains(inst->GetBasicBlock()));
+
+    if (inst->IsIntegralConst()) {
+        auto val = Multiply(inst->GetIntegralConst(), scale);
+        return val.has_value() ? NewIntegralConst(*val) : nullptr;
+    }
+
+    auto scale_imm = IntegralToImm(scale);
+    if (!scale_imm.has_value()) {
+        return nullptr;
+    }
+
+    auto mul = InstBase::NewInst<isa::inst::Opcode::MULI>();
+    auto res = mul.get();
+    loop->GetPreHeader()->InsertInstBeforeTerminator(std::move(mul));
+    res->SetInput(0, inst);
+    static_cast<BinImmT*>(res)->SetImmediate(0, *scale_imm);
+
+    return res;
+}
+
+// 1. IF_IMM i, N / IF i, N
+// ->
+// 1. IF_IMM r, N * scale / IF r, N * scale
+// only performed if i is used for nothing but it's own update and the exit condition, which is
+// checked on each iteration. initial value of i and N should be constant and i * scale should
+// not overflow until i passes N, otherwise the condition on r may differ
+void StrengthReduction::ReplaceExitCondition(const BasicIV& biv)
+{
+    const ReducedIV* reduced = nullptr;
+    for (const auto& [key, red] : reduced_) {
+        if (key.first == biv.phi && red.scale > 0) {
+            reduced = &red;
+            break;
+        }
+    }
+
+    if (reduced == nullptr) {
+        return;
+    }
+
+    std::vector<std::pair<InstBase*, InstBase*> > compares{};
+    for (const auto& [iv, from] : { std::make_pair(biv.phi, biv.update),
+                                    std::make_pair(biv.update, biv.phi) }) {
+        for (const auto& user : iv->GetUsers()) {
+            auto inst = user.GetInst();
+            if (inst == from || IsDead(inst)) {
+                continue;
+            }
+            if (inst->GetOpcode() != isa::inst::Opcode::IF &&
+                inst->GetOpcode() != isa::inst::Opcode::IF_IMM) {
+                return;
+            }
+            compares.emplace_back(inst, iv);
+        }
+    }
+
+    if (compares.size() != 1) {
+        return;
+    }
+
+    auto [cmp, iv] = compares.front();
+    auto new_iv = (iv == biv.phi) ? reduced->phi : reduced->update;
+    auto loop = biv.loop;
+
+    auto cmp_bb = cmp->GetBasicBlock();
+    if (!loop->Contains(cmp_bb) || !IsLoopExit(loop, cmp_bb) ||
+        !cmp_bb->Dominates(loop->GetBackEdges().front())) {
+        return;
+    }
+
+    // equality may hold for r and not for i, as multiplication is not injective modulo 2^64
+    auto cond = (cmp->GetOpcode() == isa::inst::Opcode::IF_IMM)
+                    ? static_cast<isa::inst_type::IF_IMM*>(cmp)->GetCondition()
+                    : static_cast<isa::inst_type::IF*>(cmp)->GetCondition();
+    if (cond == Conditional::Type::EQ || cond == Conditional::Type::NEQ ||
+        !biv.init->IsIntegralConst()) {
+        return;
+    }
+    auto init = biv.init->GetIntegralConst();
+
+    if (cmp->GetOpcode() == isa::inst::Opcode::IF_IMM) {
+        using IfImmT = isa::inst::Inst<isa::inst::Opcode::IF_IMM>::Type;
+        auto if_imm = static_cast<IfImmT*>(cmp);
+        auto imm = if_imm->GetIntegralImm(0);
+        if (!imm.has_value() || !IsScaledRangeExact(init, *imm, biv.step, reduced->scale)) {
+            return;
+        }
+        auto new_imm = IntegralToImm(*Multiply(*imm, reduced->scale));
+        if (!new_imm.has_value()) {
+            return;
+        }
+        if_imm->SetImmediate(0, *new_imm);
+    } else {
+        ASSERT(cmp->GetOpcode() == isa::inst::Opcode::IF);
+        unsigned limit_idx = (cmp->GetInput(0).GetInst() == iv) ? 1 : 0;
+        auto limit = cmp->GetInput(limit_idx).GetInst();
+        if (limit == iv || !limit->IsIntegralConst()) {
+            return;
+        }
+        auto limit_val = limit->GetIntegralConst();
+        if (!IsScaledRangeExact(init, limit_val, biv.step, reduced->scale)) {
+            return;
+        }
+
+        auto new_limit = ScaleInvariant(loop, limit, reduced->scale);
+        ASSERT(new_limit != nullptr);
+        limit->RemoveUser(cmp);
+        cmp->ReplaceInput(limit, new_limit);
+        new_limit->AddUser(cmp, limit_idx);
+    }
+
+    unsigned iv_idx = (cmp->GetInput(0).GetInst() == iv) ? 0 : 1;
+    iv->RemoveUser(cmp);
+    cmp->ReplaceInput(iv, new_iv);
+    new_iv->AddUser(cmp, iv_idx);
+
+    changed_ = true;
+}
+
+InstBase* StrengthReduction::NewIntegralConst(int64_t val)
+{
+    graph_->GetStartBasicBlock()->PushBackInst(InstBase::NewInst<isa::inst::Opcode::CONST>(val));
+    return graph_->GetStartBasicBlock()->GetLastInst();
+}
+
+void StrengthReduction::ResetState()
+{
+    iv_analysis_ = nullptr;
+    reduced_.clear();
+    changed_ = false;
+}
@@ -0,0 +1,65 @@
+#ifndef __PASS_STRENGTH_REDUCTION_INCLUDED__
+#define __PASS_STRENGTH_REDUCTION_INCLUDED__
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <utility>
+
+#include "induction_variable_analysis.h"
+#include "pass.h"
+
+class BasicBlock;
+class InstBase;
+class Loop;
+
+// replaces multiplications of induction variables with additive recurrences:
+//
+// header:                            header:
+//   i = PHI(i0, i1)                    i = PHI(i0, i1)
+//                                      r = PHI(i0 * k, r1)
+// body:                    ->        body:
+//   j = MULI i, k                      ...j users use r...
+//   i1 = ADDI i, s                     i1 = ADDI i, s
+//                                      r1 = ADDI r, s * k
+//
+// and rewrites loop exit conditions on i to use r, so that i becomes dead. reductions, which
+// constants overflow int64_t, are skipped
+class StrengthReduction : public Pass
+{
+  public:
+    StrengthReduction(Graph* graph) : Pass(graph)
+    {
+    }
+
+    NO_COPY_SEMANTIC(StrengthReduction);
+    NO_MOVE_SEMANTIC(StrengthReduction);
+
+    bool Run() override;
+
+  private:
+    using BasicIV = InductionVariableAnalysis::BasicInductionVariable;
+    using DerivedIV = InductionVariableAnalysis::DerivedInductionVariable;
+
+    // reduced induction variable r = i * scale
+    struct ReducedIV
+    {
+        InstBase* phi{ nullptr };
+        InstBase* update{ nullptr };
+        int64_t scale{ 0 };
+    };
+
+    void ProcessLoop(Loop* loop);
+    void ReduceDerived(const DerivedIV& div);
+    std::optional<ReducedIV> GetOrCreateReduced(const BasicIV& biv, int64_t scale);
+    InstBase* ScaleInvariant(Loop* loop, InstBase* inst, int64_t scale);
+    void ReplaceExitCondition(const BasicIV& biv);
+    InstBase* NewIntegralConst(int64_t val);
+    void ResetState();
+
+    InductionVariableAnalysis* iv_analysis_{ nullptr };
+    std::map<std::pair<InstBase*, int64_t>, ReducedIV> reduced_{};
+    bool changed_{ false };
+};
+
+#endif
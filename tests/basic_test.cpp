@@ -115,3 +115,51 @@ TEST(BasicTests, Example1)
     ASSERT_EQ(bb_pred.size(), 1);
     ASSERT_EQ(bb_pred[0]->GetId(), b0);
 }
+
+TEST(BasicTests, InputSources)
+{
+    Graph g;
+    auto bb0 = g.NewBasicBlock();
+    auto bb1 = g.NewBasicBlock();
+    auto bb2 = g.NewBasicBlock();
+
+    auto c0 = InstBase::NewInst<isa::inst::Opcode::CONST>(1);
+    auto c1 = InstBase::NewInst<isa::inst::Opcode::CONST>(2);
+    auto add = InstBase::NewInst<isa::inst::Opcode::ADD>();
+    auto phi = InstBase::NewInst<isa::inst::Opcode::PHI>();
+    c0->SetBasicBlock(bb0);
+    c1->SetBasicBlock(bb1);
+    add->SetBasicBlock(bb2);
+    phi->SetBasicBlock(bb2);
+
+    // source block of non-phi input is the block of the input
+    add->SetInput(0, c0.get());
+    add->SetInput(1, c1.get());
+    ASSERT_EQ(add->GetInput(0).GetSourceBB(), bb0);
+    c0->SetBasicBlock(bb1);
+    ASSERT_EQ(add->GetInput(0).GetSourceBB(), bb1);
+
+    // phi sources follow inputs
+    phi->AddInput(c0.get(), bb0);
+    phi->AddInput(c1.get(), bb1);
+    phi->AddInput(c0.get(), bb2);
+    phi->RemoveInput(Input(c1.get(), bb1));
+    ASSERT_EQ(phi->GetNumInputs(), 2);
+    ASSERT_EQ(phi->GetInput(0).GetSourceBB(), bb0);
+    ASSERT_EQ(phi->GetInput(1).GetInst(), c0.get());
+    ASSERT_EQ(phi->GetInput(1).GetSourceBB(), bb2);
+
+    auto inputs = phi->GetInputs();
+    ASSERT_EQ(inputs.size(), 2);
+    ASSERT_EQ(inputs[1].GetSourceBB(), bb2);
+
+    // stored inputs and phi sources are viewed without copying
+    auto insts = phi->GetInputInsts();
+    auto sources = phi->GetPhiSources();
+    ASSERT_EQ(insts.size(), 2);
+    ASSERT_EQ(sources.size(), 2);
+    ASSERT_EQ(insts[1], c0.get());
+    ASSERT_EQ(sources[1], bb2);
+    ASSERT_EQ(phi->GetPhiInput(bb2), c0.get());
+    ASSERT_EQ(add->GetInputInsts()[1], c1.get());
+}
@@ -0,0 +1,170 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+
+#include "gtest/gtest.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static constexpr double EPS = 1e-9;
+
+TEST(TestBlockFrequency, Loop)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            IF P0, P1, GEQ -> X
+        X:
+            RETURN_VOID
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto H = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::GEQ);
+    auto B = b.NewBlock();
+    auto X = b.NewBlock();
+    (void)b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, P0, P1);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto freq = g.GetPassManager()->GetValidPass<BlockFrequency>();
+    auto bb_h = g.GetBasicBlock(H);
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_x = g.GetBasicBlock(X);
+
+    // loop exit and return heuristics agree
+    auto exit_prob = freq->GetProbability(bb_h, bb_x);
+    ASSERT_LT(exit_prob, BlockFrequency::LOOP_EXIT_PROBABILITY);
+    ASSERT_NEAR(freq->GetProbability(bb_h, bb_b), 1.0 - exit_prob, EPS);
+
+    ASSERT_NEAR(freq->GetFrequency(g.GetStartBasicBlock()), 1.0, EPS);
+    ASSERT_NEAR(freq->GetFrequency(bb_h), 1.0 / exit_prob, EPS);
+    ASSERT_NEAR(freq->GetFrequency(bb_b), 1.0 / exit_prob - 1.0, EPS);
+    ASSERT_NEAR(freq->GetFrequency(bb_x), 1.0, EPS);
+}
+
+TEST(TestBlockFrequency, CheckFailureIsCold)
+{
+    /*
+        START -> A -> F -> J
+                 |         ^
+                 v         |
+                 T --------+
+
+        A:
+            IF_IMM P0, 0, EQ -> T
+        T:
+            CHECK_ZERO P0
+        F:
+            CHECK_ZERO P0
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    auto F = b.NewBlock();
+    auto CHK0 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto T = b.NewBlock();
+    auto CHK1 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto J = b.NewBlock();
+    (void)b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, P0);
+    b.SetImmediate(IF0, 0, 0);
+    b.SetInputs(CHK0, P0);
+    b.SetInputs(CHK1, P0);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { F, T });
+    b.SetSuccessors(F, { J });
+    b.SetSuccessors(T, { J });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto freq = g.GetPassManager()->GetValidPass<BlockFrequency>();
+    auto bb_a = g.GetBasicBlock(A);
+    auto bb_t = g.GetBasicBlock(T);
+
+    auto prob = freq->GetProbability(bb_a, bb_t);
+    ASSERT_LT(prob, BlockFrequency::CHECK_FAILURE_PROBABILITY);
+    ASSERT_NEAR(freq->GetFrequency(bb_t), prob, EPS);
+    ASSERT_NEAR(freq->GetFrequency(g.GetBasicBlock(F)), 1.0 - prob, EPS);
+    ASSERT_NEAR(freq->GetFrequency(g.GetBasicBlock(J)), 1.0, EPS);
+}
+
+TEST(TestBlockFrequency, Profile)
+{
+    /*
+        START -> A -> F -> J
+                 |         ^
+                 v         |
+                 T --------+
+
+        A:
+            IF_IMM P0, 0, EQ -> T
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    auto F = b.NewBlock();
+    auto T = b.NewBlock();
+    auto J = b.NewBlock();
+    (void)b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, P0);
+    b.SetImmediate(IF0, 0, 0);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { F, T });
+    b.SetSuccessors(F, { J });
+    b.SetSuccessors(T, { J });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto bb_a = g.GetBasicBlock(A);
+    auto bb_t = g.GetBasicBlock(T);
+
+    auto freq = g.GetPassManager()->GetValidPass<BlockFrequency>();
+    ASSERT_NEAR(freq->GetProbability(bb_a, bb_t), BlockFrequency::ZERO_COMPARISON_PROBABILITY,
+                EPS);
+
+    g.GetProfile()->SetEdgeCount(A, T, 70);
+    g.GetProfile()->SetEdgeCount(A, F, 30);
+    freq->Run();
+    ASSERT_NEAR(freq->GetProbability(bb_a, bb_t), 0.7, EPS);
+    ASSERT_NEAR(freq->GetFrequency(bb_t), 0.7, EPS);
+    ASSERT_NEAR(freq->GetFrequency(g.GetBasicBlock(J)), 1.0, EPS);
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,144 @@
+#include "bb.h"
+#include "call_graph.h"
+#include "graph.h"
+#include "graph_builder.h"
+
+#include "gtest/gtest.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+// ret callee(P0) + 1 or ret P0 + 1 if callee is nullptr
+static void BuildFunction(Graph* g, Graph* callee)
+{
+    GraphBuilder b(g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto value = P0;
+    if (callee != nullptr) {
+        auto CALL = b.NewInst<isa::inst::Opcode::CALL_STATIC>(callee);
+        b.SetInputs(CALL, P0);
+        value = CALL;
+    }
+    auto I0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto I1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, value);
+    b.SetImmediate(I0, 0, 1);
+    b.SetInputs(I1, I0);
+
+    b.SetSuccessors(START, { A });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+}
+
+static size_t CountCalls(Graph* graph)
+{
+    size_t res = 0;
+    for (auto bb : graph->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            res += (inst->GetOpcode() == isa::inst::Opcode::CALL_STATIC) ? 1 : 0;
+        }
+    }
+    return res;
+}
+
+TEST(TestCallGraph, BottomUpOrder)
+{
+    /*
+        main -> f -> g
+    */
+    Graph g;
+    BuildFunction(&g, nullptr);
+    Graph f;
+    BuildFunction(&f, &g);
+    Graph main;
+    BuildFunction(&main, &f);
+
+    // callees are discovered through calls
+    CallGraph cg{ { &main } };
+    ASSERT_TRUE(cg.Contains(&f));
+    ASSERT_TRUE(cg.Contains(&g));
+
+    ASSERT_EQ(cg.GetCallees(&main), std::vector<Graph*>{ &f });
+    ASSERT_EQ(cg.GetCallers(&g), std::vector<Graph*>{ &f });
+    ASSERT_EQ(cg.GetCallSites(&f).size(), 1);
+    ASSERT_TRUE(cg.GetCallees(&g).empty());
+
+    ASSERT_EQ(cg.GetSCCs().size(), 3);
+    ASSERT_EQ(cg.GetBottomUpOrder(), (std::vector<Graph*>{ &g, &f, &main }));
+    ASSERT_FALSE(cg.IsRecursive(&main));
+    ASSERT_FALSE(cg.IsRecursive(&f));
+    ASSERT_FALSE(cg.IsRecursive(&g));
+
+    // f is inlined after g was inlined into it
+    cg.RunBottomUp<Inlining>();
+    ASSERT_EQ(CountCalls(&f), 0);
+    ASSERT_EQ(CountCalls(&main), 0);
+
+    cg.Build();
+    ASSERT_TRUE(cg.GetCallees(&main).empty());
+    // calls were inlined, so f and g are not reachable anymore
+    ASSERT_FALSE(cg.Contains(&f));
+    ASSERT_FALSE(cg.Contains(&g));
+}
+
+TEST(TestCallGraph, Recursion)
+{
+    /*
+        main -> f <-> g
+        main -> h -> h
+    */
+    Graph f;
+    Graph g;
+    BuildFunction(&f, &g);
+    BuildFunction(&g, &f);
+    Graph h;
+    BuildFunction(&h, &h);
+
+    Graph main;
+    {
+        GraphBuilder b(&main);
+
+        auto START = Graph::BB_START_ID;
+        auto P0 = b.NewParameter();
+
+        auto A = b.NewBlock();
+        auto I0 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&f);
+        auto I1 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&h);
+        auto I2 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+        b.SetInputs(I0, P0);
+        b.SetInputs(I1, I0);
+        b.SetInputs(I2, I1);
+
+        b.SetSuccessors(START, { A });
+
+        b.ConstructCFG();
+        b.ConstructDFG();
+        ASSERT_TRUE(b.RunChecks());
+    }
+
+    CallGraph cg{ { &main } };
+    ASSERT_EQ(cg.GetCallees(&main), (std::vector<Graph*>{ &f, &h }));
+    ASSERT_EQ(cg.GetCallers(&f), (std::vector<Graph*>{ &main, &g }));
+    ASSERT_EQ(cg.GetCallees(&h), std::vector<Graph*>{ &h });
+
+    auto sccs = cg.GetSCCs();
+    ASSERT_EQ(sccs.size(), 3);
+    ASSERT_EQ(sccs[0].size(), 2);
+    ASSERT_EQ(sccs[1], std::vector<Graph*>{ &h });
+    ASSERT_EQ(sccs[2], std::vector<Graph*>{ &main });
+
+    ASSERT_TRUE(cg.IsRecursive(&f));
+    ASSERT_TRUE(cg.IsRecursive(&g));
+    ASSERT_TRUE(cg.IsRecursive(&h));
+    ASSERT_FALSE(cg.IsRecursive(&main));
+}
+
+#pragma GCC diagnostic pop
@@ -993,3 +993,162 @@ TEST(TestCheckElimination, TestNoRemoveNotEquivalent)
     CheckInputs(r0, {});
     CheckUsers(r0, {});
 }
+
+TEST(TestCheckElimination, TestImpliedByCondition)
+{
+    /*
+    +-------+
+    | START |
+    +-------+
+      |
+      |
+      v
+    +-------+     +---+
+    |   A   | --> | C |
+    +-------+     +---+
+      |
+      |
+      v
+    +-------+
+    |   B   |
+    +-------+
+
+    A:
+        IF_IMM P0, 0, NEQ -> C
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::NEQ);
+
+    auto B = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    auto C = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto I2 = b.NewInst<isa::inst::Opcode::CHECK_NULL>();
+    auto R1 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, P0);
+    b.SetImmediate(IF0, 0, 0);
+    b.SetInputs(I0, P0);
+    b.SetInputs(I1, P0);
+    b.SetInputs(I2, P0);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->GetValidPass<CheckElimination>();
+
+    // P0 may be zero on the fallthrough path
+    auto bb_b = g.GetBasicBlock(B);
+    ASSERT_NE(bb_b->GetFirstInst(), nullptr);
+    ASSERT_EQ(bb_b->GetFirstInst()->GetId(), I0);
+    ASSERT_EQ(bb_b->GetFirstInst()->GetNext()->GetId(), R0);
+
+    // P0 != 0 on the true path
+    auto bb_c = g.GetBasicBlock(C);
+    ASSERT_NE(bb_c->GetFirstInst(), nullptr);
+    ASSERT_EQ(bb_c->GetFirstInst()->GetId(), R1);
+    ASSERT_EQ(bb_c->GetFirstInst()->GetNext(), nullptr);
+
+    auto p0 = g.GetStartBasicBlock()->GetFirstInst();
+    CheckUsers(p0, { { IF0, 0 }, { I0, 0 } });
+}
+
+TEST(TestCheckElimination, TestImpliedByFloatCondition)
+{
+    /*
+    +-------+
+    | START |
+    +-------+
+      |
+      |
+      v
+    +-------+     +---+     +---+
+    |   A   | --> | C | --> | E |
+    +-------+     +---+     +---+
+      |             |
+      |             |
+      v             v
+    +-------+     +---+
+    |   B   |     | D |
+    +-------+     +---+
+
+    A:
+        IF P0, -0.0, EQ -> C
+    C:
+        IF_IMM P1, 0.5, NEQ -> E
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+    auto C0 = b.NewConst(-0.0);
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+
+    auto B = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    auto C = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto IF1 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::NEQ);
+
+    auto D = b.NewBlock();
+    auto R1 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    auto E = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto R2 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, P0, C0);
+    b.SetInputs(I0, P0);
+    b.SetInputs(I1, P0);
+    b.SetInputs(IF1, P1);
+    b.SetImmediate(IF1, 0, 0.5);
+    b.SetInputs(I2, P1);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+    b.SetSuccessors(C, { D, E });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->GetValidPass<CheckElimination>();
+
+    // P0 != -0.0 on the fallthrough path, so P0 != 0
+    auto bb_b = g.GetBasicBlock(B);
+    ASSERT_NE(bb_b->GetFirstInst(), nullptr);
+    ASSERT_EQ(bb_b->GetFirstInst()->GetId(), R0);
+
+    // P0 == -0.0 on the true path, which is zero
+    auto bb_c = g.GetBasicBlock(C);
+    ASSERT_NE(bb_c->GetFirstInst(), nullptr);
+    ASSERT_EQ(bb_c->GetFirstInst()->GetId(), I1);
+
+    ASSERT_EQ(g.GetBasicBlock(D)->GetFirstInst()->GetId(), R1);
+
+    // P1 != 0.5 says nothing about P1 being zero
+    auto bb_e = g.GetBasicBlock(E);
+    ASSERT_NE(bb_e->GetFirstInst(), nullptr);
+    ASSERT_EQ(bb_e->GetFirstInst()->GetId(), I2);
+    ASSERT_EQ(bb_e->GetFirstInst()->GetNext()->GetId(), R2);
+}
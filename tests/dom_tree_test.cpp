@@ -665,6 +665,70 @@ TEST(TestDomTree, Example6)
 
     g.GetPassManager()->Run<DomTree>();
     CheckImmDoms();
+
+    // numbered dominance matches walk over immediate dominators
+    std::vector<IdType> ids = { START, A, B, C, D, E, F, G, H };
+    for (auto id1 : ids) {
+        for (auto id2 : ids) {
+            auto bb1 = g.GetBasicBlock(id1);
+            auto bb2 = g.GetBasicBlock(id2);
+
+            bool dominates = false;
+            for (auto dom = bb2; dom != nullptr; dom = dom->GetImmDominator()) {
+                dominates |= (dom == bb1);
+            }
+            ASSERT_EQ(bb1->Dominates(bb2), dominates) << IdToChar(id1) << " " << IdToChar(id2);
+        }
+    }
+}
+
+TEST(TestDomTree, InstOrder)
+{
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto I2 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, P0);
+    b.SetInputs(I1, I0);
+    b.SetInputs(I2, I1);
+
+    b.SetSuccessors(START, { A });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<DomTree>();
+
+    auto bb = g.GetBasicBlock(A);
+    auto i0 = bb->GetFirstInst();
+    auto i1 = i0->GetNext();
+    auto i2 = i1->GetNext();
+
+    ASSERT_TRUE(i0->Precedes(i2));
+    ASSERT_TRUE(i0->Dominates(i1));
+    ASSERT_FALSE(i2->Precedes(i1));
+    ASSERT_TRUE(g.GetStartBasicBlock()->GetFirstInst()->Dominates(i2));
+
+    // order is updated after insertion
+    auto inst = InstBase::NewInst<isa::inst::Opcode::ADDI>();
+    auto new_inst = inst.get();
+    bb->InsertInstBefore(std::move(inst), i0);
+
+    ASSERT_TRUE(new_inst->Precedes(i0));
+    ASSERT_FALSE(i0->Precedes(new_inst));
+    ASSERT_TRUE(i1->Precedes(i2));
+
+    bb->UnlinkInst(i1);
+    ASSERT_TRUE(new_inst->Precedes(i2));
+    ASSERT_FALSE(i2->Precedes(i0));
 }
 
 // disabled due to check for number of successors
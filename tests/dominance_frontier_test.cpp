@@ -0,0 +1,113 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+
+#include "gtest/gtest.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static std::vector<IdType> ToIds(const std::vector<BasicBlock*>& blocks)
+{
+    std::vector<IdType> res{};
+    for (auto bb : blocks) {
+        res.push_back(bb->GetId());
+    }
+    return res;
+}
+
+TEST(TestDominanceFrontier, Example1)
+{
+    /*
+              +-------+
+              | START |
+              +-------+
+                |
+                |
+                v
+              +-------+
+              |   A   |
+              +-------+
+                |
+                |
+                v
+    +---+     +-------+
+    | D | <-- |   B   | <+
+    +---+     +-------+  |
+      |         |        |
+      |         |        |
+      |         v        |
+      |       +-------+  |
+      |       |   C   |  |
+      |       +-------+  |
+      |         |        |
+      |         |        |
+      |         v        |
+      |       +-------+  |
+      +-----> |   E   | -+
+              +-------+
+                |
+                |
+                v
+              +-------+
+              |   F   |
+              +-------+
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(1);
+    auto C1 = b.NewConst(2);
+    auto A = b.NewBlock();
+    auto B = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+    auto C = b.NewBlock();
+    auto D = b.NewBlock();
+    auto E = b.NewBlock();
+    auto IF1 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+    auto F = b.NewBlock();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, C0, C1);
+    b.SetInputs(IF1, C0, C1);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B });
+    b.SetSuccessors(B, { C, D });
+    b.SetSuccessors(C, { E });
+    b.SetSuccessors(D, { E });
+    b.SetSuccessors(E, { F, B });
+    b.SetSuccessors(F, {});
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto df = g.GetPassManager()->GetValidPass<DominanceFrontier>();
+
+    using Ids = std::vector<IdType>;
+    ASSERT_EQ(ToIds(df->GetFrontier(g.GetBasicBlock(START))), Ids{});
+    ASSERT_EQ(ToIds(df->GetFrontier(g.GetBasicBlock(A))), Ids{});
+    ASSERT_EQ(ToIds(df->GetFrontier(g.GetBasicBlock(B))), Ids{ B });
+    ASSERT_EQ(ToIds(df->GetFrontier(g.GetBasicBlock(C))), Ids{ E });
+    ASSERT_EQ(ToIds(df->GetFrontier(g.GetBasicBlock(D))), Ids{ E });
+    ASSERT_EQ(ToIds(df->GetFrontier(g.GetBasicBlock(E))), Ids{ B });
+    ASSERT_EQ(ToIds(df->GetFrontier(g.GetBasicBlock(F))), Ids{});
+
+    // definition in C requires phis in E and, through the back edge, in B
+    ASSERT_EQ(ToIds(df->GetIteratedFrontier({ g.GetBasicBlock(C) })), (Ids{ B, E }));
+    ASSERT_EQ(ToIds(df->GetIteratedFrontier({ g.GetBasicBlock(A), g.GetBasicBlock(F) })), Ids{});
+
+    // frontiers are recomputed after CFG modification
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_new = g.NewBasicBlock();
+    g.InsertBasicBlock(bb_new, bb_b, g.GetBasicBlock(C));
+    ASSERT_FALSE(g.GetPassManager()->IsValid<DominanceFrontier>());
+
+    df = g.GetPassManager()->GetValidPass<DominanceFrontier>();
+    ASSERT_EQ(ToIds(df->GetFrontier(bb_new)), Ids{ E });
+}
+
+#pragma GCC diagnostic pop
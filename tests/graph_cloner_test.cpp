@@ -0,0 +1,194 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+#include "graph_cloner.h"
+
+#include "gtest/gtest.h"
+
+#include <unordered_set>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static std::vector<InstBase*> CollectInsts(BasicBlock* bb)
+{
+    std::vector<InstBase*> res{};
+    for (auto i = bb->GetFirstPhi(); i != nullptr; i = i->GetNext()) {
+        res.push_back(i);
+    }
+    for (auto i = bb->GetFirstInst(); i != nullptr; i = i->GetNext()) {
+        res.push_back(i);
+    }
+    return res;
+}
+
+static void BuildLoop(Graph* g)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(0, i1)
+            s = PHI(p0, s1)
+            IF_IMM i, 10
+        B:
+            s1 = MUL s, i
+            i1 = ADDI i, 1
+        X:
+            RETURN s
+    */
+
+    GraphBuilder b(g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto C0 = b.NewConst(0);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto I1 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::GEQ);
+
+    auto B = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::MUL>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I4 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { C0, START }, { I3, B } });
+    b.SetInputs(I1, { { P0, START }, { I2, B } });
+    b.SetInputs(IF0, I0);
+    b.SetImmediate(IF0, 0, 10);
+    b.SetInputs(I2, I1, I0);
+    b.SetInputs(I3, I0);
+    b.SetImmediate(I3, 0, 1);
+    b.SetInputs(I4, I1);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+}
+
+TEST(TestGraphCloner, CloneGraph)
+{
+    Graph src;
+    BuildLoop(&src);
+
+    Graph dst;
+    GraphCloner cloner{ &dst };
+    cloner.MapBlock(src.GetStartBasicBlock(), dst.GetStartBasicBlock());
+    cloner.CloneGraph(&src);
+
+    auto src_blocks = src.GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+    auto dst_blocks = dst.GetPassManager()->GetValidPass<RPO>()->GetBlocks();
+    ASSERT_EQ(src_blocks.size(), dst_blocks.size());
+
+    std::unordered_set<BasicBlock*> dst_set(dst_blocks.begin(), dst_blocks.end());
+
+    for (size_t i = 0; i < src_blocks.size(); ++i) {
+        auto src_bb = src_blocks[i];
+        auto dst_bb = dst_blocks[i];
+        ASSERT_EQ(cloner.GetClone(src_bb), dst_bb);
+        ASSERT_EQ(src_bb->GetNumPredecessors(), dst_bb->GetNumPredecessors());
+
+        for (unsigned s = 0; s < src_bb->GetNumSuccessors(); ++s) {
+            if (src_bb->GetSuccessor(s) != nullptr) {
+                ASSERT_EQ(cloner.GetClone(src_bb->GetSuccessor(s)), dst_bb->GetSuccessor(s));
+            }
+        }
+
+        auto src_insts = CollectInsts(src_bb);
+        auto dst_insts = CollectInsts(dst_bb);
+        ASSERT_EQ(src_insts.size(), dst_insts.size());
+
+        for (size_t j = 0; j < src_insts.size(); ++j) {
+            auto src_inst = src_insts[j];
+            auto dst_inst = dst_insts[j];
+            ASSERT_NE(src_inst, dst_inst);
+            ASSERT_EQ(cloner.GetClone(src_inst), dst_inst);
+            ASSERT_EQ(src_inst->GetOpcode(), dst_inst->GetOpcode());
+            ASSERT_EQ(src_inst->GetDataType(), dst_inst->GetDataType());
+            ASSERT_EQ(src_inst->GetNumInputs(), dst_inst->GetNumInputs());
+            ASSERT_EQ(src_inst->GetNumUsers(), dst_inst->GetNumUsers());
+            ASSERT_EQ(dst_inst->GetBasicBlock(), dst_bb);
+
+            for (unsigned k = 0; k < src_inst->GetNumInputs(); ++k) {
+                auto input = dst_inst->GetInput(k);
+                ASSERT_EQ(cloner.GetClone(src_inst->GetInput(k).GetInst()), input.GetInst());
+                ASSERT_EQ(dst_set.count(input.GetSourceBB()), 1);
+            }
+        }
+    }
+
+    auto src_if = src_blocks[1]->GetLastInst();
+    auto dst_if = dst_blocks[1]->GetLastInst();
+    using IfImmT = isa::inst::Inst<isa::inst::Opcode::IF_IMM>::Type;
+    ASSERT_EQ(static_cast<IfImmT*>(dst_if)->GetImm(0), 10);
+    ASSERT_EQ(static_cast<IfImmT*>(dst_if)->GetCondition(), Conditional::Type::GEQ);
+
+    auto root = dst.GetPassManager()->GetValidPass<LoopAnalysis>()->GetRootLoop();
+    ASSERT_EQ(root->GetInnerLoops().size(), 1);
+}
+
+TEST(TestGraphCloner, CloneLoop)
+{
+    Graph g;
+    BuildLoop(&g);
+
+    g.GetPassManager()->GetValidPass<LoopAnalysis>();
+    auto loop = g.GetBasicBlock(1)->GetLoop();
+    auto header = loop->GetHeader();
+    auto pre_header = loop->GetPreHeader();
+    auto back_edge = loop->GetBackEdges().front();
+
+    auto c0 = g.GetStartBasicBlock()->GetLastInst();
+    ASSERT_TRUE(c0->IsConst());
+
+    GraphCloner cloner{ &g };
+    cloner.CloneLoop(loop);
+
+    auto clone_header = cloner.GetClone(header);
+    auto clone_back_edge = cloner.GetClone(back_edge);
+    ASSERT_NE(clone_header, nullptr);
+    ASSERT_NE(clone_back_edge, nullptr);
+    ASSERT_EQ(cloner.GetClone(pre_header), nullptr);
+
+    // edge to the exit is left unset, back edge is recreated
+    ASSERT_EQ(clone_header->GetSuccessor(Conditional::Branch::FALLTHROUGH), clone_back_edge);
+    ASSERT_EQ(clone_header->GetSuccessor(Conditional::Branch::BRANCH_TRUE), nullptr);
+    ASSERT_EQ(clone_header->GetNumPredecessors(), 1);
+    ASSERT_EQ(clone_header->GetPredecessor(0), clone_back_edge);
+
+    // values from outside are used as is, phi inputs from outside keep their source
+    for (auto phi = header->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        auto clone = cloner.GetClone(phi);
+        ASSERT_NE(clone, phi);
+        for (const auto& input : phi->GetInputs()) {
+            bool found = false;
+            for (const auto& clone_input : clone->GetInputs()) {
+                if (input.GetSourceBB() == pre_header) {
+                    found |= clone_input.GetSourceBB() == pre_header &&
+                             clone_input.GetInst() == input.GetInst();
+                } else {
+                    found |= clone_input.GetSourceBB() == clone_back_edge &&
+                             clone_input.GetInst() == cloner.GetClone(input.GetInst());
+                }
+            }
+            ASSERT_TRUE(found);
+        }
+    }
+
+    // source loop is intact, c0 is shared by both loops
+    ASSERT_EQ(header->GetNumPredecessors(), 2);
+    ASSERT_EQ(c0->GetNumUsers(), 2);
+}
+
+#pragma GCC diagnostic pop
@@ -86,7 +86,8 @@ TEST(TestInlining, Example0)
     caller.GetPassManager()->GetValidPass<DCE>();
     caller.GetPassManager()->GetValidPass<DBE>();
 
-    ASSERT_EQ(callee.GetStartBasicBlock(), nullptr);
+    // callee is left intact
+    ASSERT_TRUE(callee.GetStartBasicBlock()->GetFirstInst()->IsParam());
 
     auto start = caller.GetStartBasicBlock();
     ASSERT_TRUE(start->HasNoPredecessors());
@@ -201,7 +202,8 @@ TEST(TestInlining, Example1)
     caller.GetPassManager()->GetValidPass<DCE>();
     caller.GetPassManager()->GetValidPass<DBE>();
 
-    ASSERT_EQ(callee.GetStartBasicBlock(), nullptr);
+    // callee is left intact
+    ASSERT_TRUE(callee.GetStartBasicBlock()->GetFirstInst()->IsParam());
 
     // CFG
     auto start = caller.GetStartBasicBlock();
@@ -403,7 +405,8 @@ TEST(TestInlining, Example2)
     caller.GetPassManager()->GetValidPass<DCE>();
     caller.GetPassManager()->GetValidPass<DBE>();
 
-    ASSERT_EQ(callee.GetStartBasicBlock(), nullptr);
+    // callee is left intact
+    ASSERT_TRUE(callee.GetStartBasicBlock()->GetFirstInst()->IsParam());
 
     // CFG
     auto start = caller.GetStartBasicBlock();
@@ -722,4 +725,290 @@ TEST(TestInlining, Example3)
     CheckUsers(i5, {});
 }
 
+
+TEST(TestInlining, SameCalleeTwice)
+{
+    /*
+        callee:
+            ret P0 + 1
+
+        caller:
+            A:
+                a = call callee(P0)
+            B:
+                b = call callee(a)
+                ret b
+    */
+    Graph callee;
+    {
+        GraphBuilder b{ &callee };
+
+        auto START = Graph::BB_START_ID;
+        auto P0 = b.NewParameter();
+
+        auto A = b.NewBlock();
+        auto I0 = b.NewInst<isa::inst::Opcode::ADDI>();
+        auto I1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+        b.SetInputs(I0, P0);
+        b.SetImmediate(I0, 0, 1);
+        b.SetInputs(I1, I0);
+
+        b.SetSuccessors(START, { A });
+
+        b.ConstructCFG();
+        b.ConstructDFG();
+        ASSERT_TRUE(b.RunChecks());
+    }
+
+    Graph caller;
+    {
+        GraphBuilder b(&caller);
+
+        auto START = Graph::BB_START_ID;
+        auto P0 = b.NewParameter();
+
+        auto A = b.NewBlock();
+        auto I0 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&callee);
+
+        auto B = b.NewBlock();
+        auto I1 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&callee);
+        auto I2 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+        b.SetInputs(I0, P0);
+        b.SetInputs(I1, I0);
+        b.SetInputs(I2, I1);
+
+        b.SetSuccessors(START, { A });
+        b.SetSuccessors(A, { B });
+
+        b.ConstructCFG();
+        b.ConstructDFG();
+        ASSERT_TRUE(b.RunChecks());
+    }
+
+    caller.GetPassManager()->GetValidPass<Inlining>();
+    caller.GetPassManager()->GetValidPass<DBE>();
+
+    // callee is not modified
+    auto callee_start = callee.GetStartBasicBlock();
+    auto callee_p0 = callee_start->GetFirstInst();
+    ASSERT_TRUE(callee_p0->IsParam());
+    ASSERT_EQ(callee_p0->GetUsers().size(), 1);
+    auto callee_i0 = callee_p0->GetUsers().front().GetInst();
+    ASSERT_EQ(callee_i0->GetOpcode(), isa::inst::Opcode::ADDI);
+    ASSERT_EQ(callee_i0->GetBasicBlock(), callee_start->GetSuccessor(0));
+
+    // ret ((P0 + 1) + 1)
+    std::vector<InstBase*> insts{};
+    for (auto bb : caller.GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            ASSERT_NE(inst->GetOpcode(), isa::inst::Opcode::CALL_STATIC);
+            insts.push_back(inst);
+        }
+    }
+
+    ASSERT_EQ(insts.size(), 4);
+    auto p0 = insts[0];
+    auto i0 = insts[1];
+    auto i1 = insts[2];
+    auto i2 = insts[3];
+    ASSERT_TRUE(p0->IsParam());
+    ASSERT_EQ(i0->GetOpcode(), isa::inst::Opcode::ADDI);
+    ASSERT_EQ(i1->GetOpcode(), isa::inst::Opcode::ADDI);
+    ASSERT_EQ(i2->GetOpcode(), isa::inst::Opcode::RETURN);
+    ASSERT_NE(i0, callee_i0);
+    ASSERT_NE(i1, callee_i0);
+
+    CheckInputs(i0, { { p0->GetId(), p0->GetBasicBlock()->GetId() } });
+    CheckUsers(i0, { { i1->GetId(), 0 } });
+    CheckInputs(i1, { { i0->GetId(), i0->GetBasicBlock()->GetId() } });
+    CheckUsers(i1, { { i2->GetId(), 0 } });
+}
+
+static void BuildLongCallee(Graph* callee, size_t len)
+{
+    /*
+        i0 = ADDI P0, 1
+        i1 = ADD i0, P0
+        ...
+        ret i(len - 1)
+    */
+    GraphBuilder b{ callee };
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto prev = b.NewInst<isa::inst::Opcode::ADDI>();
+    b.SetInputs(prev, P0);
+    b.SetImmediate(prev, 0, 1);
+
+    for (size_t i = 1; i < len; ++i) {
+        auto inst = b.NewInst<isa::inst::Opcode::ADD>();
+        b.SetInputs(inst, prev, P0);
+        prev = inst;
+    }
+
+    auto RET = b.NewInst<isa::inst::Opcode::RETURN>();
+    b.SetInputs(RET, prev);
+
+    b.SetSuccessors(START, { A });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+}
+
+static size_t CountCalls(Graph* graph)
+{
+    size_t res = 0;
+    for (auto bb : graph->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+            res += (inst->GetOpcode() == isa::inst::Opcode::CALL_STATIC) ? 1 : 0;
+        }
+    }
+    return res;
+}
+
+TEST(TestInlining, CostThreshold)
+{
+    // callee's cost exceeds the threshold
+    Graph callee;
+    BuildLongCallee(&callee, Inlining::INLINE_COST_THRESHOLD);
+
+    Graph caller;
+    {
+        GraphBuilder b(&caller);
+
+        auto START = Graph::BB_START_ID;
+        auto P0 = b.NewParameter();
+
+        auto A = b.NewBlock();
+        auto I0 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&callee);
+        auto I1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+        b.SetInputs(I0, P0);
+        b.SetInputs(I1, I0);
+
+        b.SetSuccessors(START, { A });
+
+        b.ConstructCFG();
+        b.ConstructDFG();
+        ASSERT_TRUE(b.RunChecks());
+    }
+
+    caller.GetPassManager()->GetValidPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(&caller), 1);
+    ASSERT_EQ(caller.GetPassManager()->GetValidPass<RPO>()->GetBlocks().size(), 2);
+}
+
+TEST(TestInlining, ConstArgumentBonus)
+{
+    // same callee, but users of the parameter are going to be folded
+    Graph callee;
+    BuildLongCallee(&callee, Inlining::INLINE_COST_THRESHOLD);
+
+    Graph caller;
+    {
+        GraphBuilder b(&caller);
+
+        auto START = Graph::BB_START_ID;
+        auto C0 = b.NewConst(2);
+
+        auto A = b.NewBlock();
+        auto I0 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&callee);
+        auto I1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+        b.SetInputs(I0, C0);
+        b.SetInputs(I1, I0);
+
+        b.SetSuccessors(START, { A });
+
+        b.ConstructCFG();
+        b.ConstructDFG();
+        ASSERT_TRUE(b.RunChecks());
+    }
+
+    caller.GetPassManager()->GetValidPass<Inlining>();
+
+    ASSERT_EQ(CountCalls(&caller), 0);
+
+    auto c0 = caller.GetStartBasicBlock()->GetFirstInst();
+    ASSERT_TRUE(c0->IsConst());
+    ASSERT_EQ(c0->GetNumUsers(), Inlining::INLINE_COST_THRESHOLD);
+}
+
+TEST(TestInlining, RecursiveCallee)
+{
+    /*
+        callee:
+            a = call callee(P0)
+            ret a
+    */
+    Graph callee;
+    {
+        GraphBuilder b{ &callee };
+
+        auto START = Graph::BB_START_ID;
+        auto P0 = b.NewParameter();
+
+        auto A = b.NewBlock();
+        auto I0 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&callee);
+        auto I1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+        b.SetInputs(I0, P0);
+        b.SetInputs(I1, I0);
+
+        b.SetSuccessors(START, { A });
+
+        b.ConstructCFG();
+        b.ConstructDFG();
+        ASSERT_TRUE(b.RunChecks());
+    }
+
+    Graph caller;
+    {
+        GraphBuilder b(&caller);
+
+        auto START = Graph::BB_START_ID;
+        auto P0 = b.NewParameter();
+
+        auto A = b.NewBlock();
+        auto I0 = b.NewInst<isa::inst::Opcode::CALL_STATIC>(&callee);
+        auto I1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+        b.SetInputs(I0, P0);
+        b.SetInputs(I1, I0);
+
+        b.SetSuccessors(START, { A });
+
+        b.ConstructCFG();
+        b.ConstructDFG();
+        ASSERT_TRUE(b.RunChecks());
+    }
+
+    // self-recursive call is inlined into the graph itself from it's copy up to the recursion
+    // depth limit, the innermost call is kept
+    auto num_blocks = callee.GetPassManager()->GetValidPass<RPO>()->GetBlocks().size();
+    callee.GetPassManager()->GetValidPass<Inlining>();
+    ASSERT_EQ(CountCalls(&callee), 1);
+    // each copy brings it's two blocks and splits the block of the call
+    ASSERT_EQ(callee.GetPassManager()->GetValidPass<RPO>()->GetBlocks().size(),
+              num_blocks + 3 * Inlining::MAX_RECURSIVE_DEPTH);
+
+    // callee is inlined into caller up to the recursion depth limit
+    caller.GetPassManager()->GetValidPass<Inlining>();
+    ASSERT_EQ(CountCalls(&caller), 1);
+
+    auto p0 = caller.GetStartBasicBlock()->GetFirstInst();
+    ASSERT_TRUE(p0->IsParam());
+    ASSERT_EQ(p0->GetNumUsers(), 1);
+    auto call = p0->GetUsers().front().GetInst();
+    ASSERT_EQ(call->GetOpcode(), isa::inst::Opcode::CALL_STATIC);
+    ASSERT_EQ(call->GetNumUsers(), 1);
+    ASSERT_TRUE(call->GetUsers().front().GetInst()->IsReturn());
+}
+
 #pragma GCC diagnostic pop
@@ -0,0 +1,92 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+#include "inst_table.h"
+
+#include "gtest/gtest.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static InstTable::Index FindIndex(const InstTable& table, IdType id)
+{
+    for (InstTable::Index idx = 0; idx < table.Size(); ++idx) {
+        if (table.GetInst(idx)->GetId() == id) {
+            return idx;
+        }
+    }
+    UNREACHABLE("no such id in the table!");
+}
+
+TEST(TestInstTable, Loop)
+{
+    /*
+    +-------+
+    | START |
+    +-------+
+      |
+      v
+    +-------+
+    |   A   | <+
+    +-------+  |
+      |    |   |
+      |    +---+
+      v
+    +-------+
+    |   B   |
+    +-------+
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(1);
+
+    auto A = b.NewBlock();
+    auto PHI = b.NewInst<isa::inst::Opcode::PHI>();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+
+    auto B = b.NewBlock();
+    auto RET = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(PHI, { { C0, START }, { I0, A } });
+    b.SetInputs(I0, PHI, C0);
+    b.SetInputs(IF0, I0, C0);
+    b.SetInputs(RET, PHI);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, A });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    InstTable table(&g);
+    ASSERT_EQ(table.Size(), 5);
+
+    // blocks in RPO, phis before instructions
+    std::vector<IdType> ids{};
+    for (InstTable::Index idx = 0; idx < table.Size(); ++idx) {
+        ASSERT_EQ(table.GetIndex(table.GetInst(idx)), idx);
+        ids.push_back(table.GetInst(idx)->GetId());
+    }
+    ASSERT_EQ(ids, std::vector<IdType>({ C0, PHI, I0, IF0, RET }));
+
+    auto phi = FindIndex(table, PHI);
+    ASSERT_EQ(table.GetOpcode(phi), isa::inst::Opcode::PHI);
+    ASSERT_EQ(table.GetBlockId(phi), A);
+
+    auto inputs = table.GetInputs(phi);
+    ASSERT_EQ(inputs.size(), 2);
+    ASSERT_EQ(table.GetInst(inputs[0])->GetId(), C0);
+    ASSERT_EQ(table.GetInst(inputs[1])->GetId(), I0);
+
+    auto ret = FindIndex(table, RET);
+    ASSERT_EQ(table.GetBlockId(ret), B);
+    ASSERT_TRUE(table.HasFlag<isa::flag::Type::NO_DCE>(ret));
+    ASSERT_FALSE(table.HasFlag<isa::flag::Type::NO_DCE>(phi));
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,185 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+
+#include "gtest/gtest.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+TEST(TestJumpThreading, PhiOfConstants)
+{
+    /*
+        START -> A -> B -> D -> E
+                 |         ^ \
+                 v         |  v
+                 C --------+  F
+
+        D:
+            x = PHI(1 from B, 2 from C)
+            IF_IMM x, 1, EQ -> F
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto C1 = b.NewConst(1);
+    auto C2 = b.NewConst(2);
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    auto B = b.NewBlock();
+    auto C = b.NewBlock();
+    auto D = b.NewBlock();
+    auto X = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF1 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    auto E = b.NewBlock();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+    auto F = b.NewBlock();
+    auto R1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(IF0, P0);
+    b.SetImmediate(IF0, 0, 0);
+    b.SetInputs(X, { { C1, B }, { C2, C } });
+    b.SetInputs(IF1, X);
+    b.SetImmediate(IF1, 0, 1);
+    b.SetInputs(R0, P0);
+    b.SetInputs(R1, P0);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+    b.SetSuccessors(B, { D });
+    b.SetSuccessors(C, { D });
+    b.SetSuccessors(D, { E, F });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<JumpThreading>();
+
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_c = g.GetBasicBlock(C);
+    auto bb_d = g.GetBasicBlock(D);
+    auto bb_e = g.GetBasicBlock(E);
+    auto bb_f = g.GetBasicBlock(F);
+
+    // predecessors of D are processed in order C, B
+    // C goes to E through the copy of D without the branch
+    auto clone = bb_c->GetSuccessor(0);
+    ASSERT_NE(clone, bb_d);
+    ASSERT_EQ(clone->GetFirstInst(), nullptr);
+    ASSERT_EQ(clone->GetSuccessor(0), bb_e);
+    ASSERT_EQ(bb_e->GetPredecessors(), std::vector<BasicBlock*>{ clone });
+
+    // B is the last predecessor of D, branch is folded
+    ASSERT_EQ(bb_b->GetSuccessor(0), bb_d);
+    ASSERT_EQ(bb_d->GetPredecessors(), std::vector<BasicBlock*>{ bb_b });
+    ASSERT_EQ(bb_d->GetFirstInst(), nullptr);
+    ASSERT_EQ(bb_d->GetNumSuccessors(), 1);
+    ASSERT_EQ(bb_d->GetSuccessor(0), bb_f);
+    ASSERT_EQ(bb_f->GetPredecessors(), std::vector<BasicBlock*>{ bb_d });
+
+    auto x = bb_d->GetFirstPhi();
+    ASSERT_EQ(x->GetNumInputs(), 1);
+    ASSERT_EQ(x->GetInput(0).GetSourceBB(), bb_b);
+    ASSERT_EQ(x->GetNumUsers(), 0);
+}
+
+TEST(TestJumpThreading, DominatingCondition)
+{
+    /*
+        START -> A -> B -> D -> E
+                 |         ^ \
+                 v         |  v
+                 C --------+  F
+
+        A:
+            IF P0, P1, EQ -> C
+        D:
+            v = ADD P0, P1
+            IF P1, P0, EQ -> F
+        E:
+            RETURN v
+        F:
+            RETURN v
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+    auto B = b.NewBlock();
+    auto C = b.NewBlock();
+    auto D = b.NewBlock();
+    auto V = b.NewInst<isa::inst::Opcode::ADD>();
+    auto IF1 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+    auto E = b.NewBlock();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+    auto F = b.NewBlock();
+    auto R1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(IF0, P0, P1);
+    b.SetInputs(V, P0, P1);
+    b.SetInputs(IF1, P1, P0);
+    b.SetInputs(R0, V);
+    b.SetInputs(R1, V);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+    b.SetSuccessors(B, { D });
+    b.SetSuccessors(C, { D });
+    b.SetSuccessors(D, { E, F });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<JumpThreading>();
+
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_c = g.GetBasicBlock(C);
+    auto bb_d = g.GetBasicBlock(D);
+    auto bb_e = g.GetBasicBlock(E);
+    auto bb_f = g.GetBasicBlock(F);
+    auto p0 = g.GetStartBasicBlock()->GetFirstInst();
+    auto p1 = p0->GetNext();
+
+    // P0 == P1 on the path through C
+    auto clone = bb_c->GetSuccessor(0);
+    ASSERT_NE(clone, bb_d);
+    ASSERT_EQ(clone->GetSuccessor(0), bb_f);
+    auto v_clone = clone->GetFirstInst();
+    ASSERT_EQ(v_clone->GetOpcode(), isa::inst::Opcode::ADD);
+    ASSERT_EQ(v_clone->GetNext(), nullptr);
+    ASSERT_EQ(v_clone->GetInput(0).GetInst(), p0);
+    ASSERT_EQ(v_clone->GetInput(1).GetInst(), p1);
+
+    // P0 != P1 on the path through B
+    auto v = bb_d->GetFirstInst();
+    ASSERT_EQ(v->GetOpcode(), isa::inst::Opcode::ADD);
+    ASSERT_EQ(v->GetNext(), nullptr);
+    ASSERT_EQ(bb_d->GetSuccessor(0), bb_e);
+    ASSERT_EQ(bb_e->GetPredecessors(), std::vector<BasicBlock*>{ bb_d });
+    ASSERT_EQ(bb_f->GetPredecessors(), std::vector<BasicBlock*>{ clone });
+
+    // uses of v are repaired
+    auto r0 = bb_e->GetFirstInst();
+    ASSERT_EQ(r0->GetInput(0).GetInst(), v);
+    ASSERT_EQ(v->GetNumUsers(), 1);
+
+    auto r1 = bb_f->GetFirstInst();
+    auto phi = bb_f->GetFirstPhi();
+    ASSERT_NE(phi, nullptr);
+    ASSERT_EQ(r1->GetInput(0).GetInst(), phi);
+    ASSERT_EQ(phi->GetNumInputs(), 1);
+    ASSERT_EQ(phi->GetInput(0).GetInst(), v_clone);
+    ASSERT_EQ(phi->GetInput(0).GetSourceBB(), clone);
+}
+
+#pragma GCC diagnostic pop
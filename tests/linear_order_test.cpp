@@ -4,6 +4,8 @@
 
 #include "gtest/gtest.h"
 
+#include <sstream>
+
 TEST(TestLinearOrder, Example0)
 {
     /*
@@ -995,3 +997,134 @@ TEST(TestLinearOrder, LoopExample3)
     ASSERT_TRUE(b.RunChecks());
     g.GetPassManager()->GetValidPass<LinearOrder>();
 }
+
+TEST(TestLinearOrder, ProfileDiamond)
+{
+    /*
+        START -> A -> B -> D
+                 |         ^
+                 v         |
+                 C --------+
+
+        A -> C is hot
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(1);
+    auto C1 = b.NewConst(2);
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+    auto B = b.NewBlock();
+    auto C = b.NewBlock();
+    auto D = b.NewBlock();
+    (void)b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, C0, C1);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+    b.SetSuccessors(B, { D });
+    b.SetSuccessors(C, { D });
+    b.SetSuccessors(D, {});
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto profile = g.GetProfile();
+    profile->SetEdgeCount(START, A, 100);
+    profile->SetEdgeCount(A, B, 10);
+    profile->SetEdgeCount(A, C, 90);
+    profile->SetEdgeCount(B, D, 10);
+    profile->SetEdgeCount(C, D, 90);
+
+    auto bb_a = g.GetBasicBlock(A);
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_c = g.GetBasicBlock(C);
+    auto bb_d = g.GetBasicBlock(D);
+
+    auto blocks = g.GetPassManager()->GetValidPass<LinearOrder>()->GetBlocks();
+    std::vector<BasicBlock*> expected{ g.GetStartBasicBlock(), bb_a, bb_c, bb_d, bb_b };
+    ASSERT_EQ(blocks, expected);
+
+    // hot successor falls through, cold block jumps back
+    ASSERT_EQ(bb_a->GetSuccessor(Conditional::Branch::FALLTHROUGH), bb_c);
+    ASSERT_EQ(bb_a->GetSuccessor(Conditional::Branch::BRANCH_TRUE), bb_b);
+    auto if_inst = static_cast<isa::inst_type::IF*>(bb_a->GetLastInst());
+    ASSERT_EQ(if_inst->GetCondition(), Conditional::Type::NEQ);
+    ASSERT_TRUE(bb_b->GetLastInst()->IsUnconditionalJump());
+    ASSERT_EQ(bb_c->GetLastInst(), nullptr);
+}
+
+TEST(TestLinearOrder, StaticLoop)
+{
+    /*
+        START -> A -> X
+                 ^ |
+                 | v
+                 B
+
+        no profile, the loop exit is unlikely by the heuristics
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(1);
+    auto C1 = b.NewConst(2);
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+    auto B = b.NewBlock();
+    auto X = b.NewBlock();
+    (void)b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, C0, C1);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { X, B });
+    b.SetSuccessors(B, { A });
+    b.SetSuccessors(X, {});
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+    ASSERT_TRUE(g.GetProfile()->IsEmpty());
+
+    auto bb_a = g.GetBasicBlock(A);
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_x = g.GetBasicBlock(X);
+
+    // loop body follows the header, exit is placed after the loop, unlike in RPO
+    auto blocks = g.GetPassManager()->GetValidPass<LinearOrder>()->GetBlocks();
+    ASSERT_EQ(blocks.size(), 5);
+    ASSERT_EQ(blocks.front(), g.GetStartBasicBlock());
+    std::vector<BasicBlock*> tail{ bb_a, bb_b, bb_x };
+    ASSERT_EQ(std::vector<BasicBlock*>(blocks.begin() + 2, blocks.end()), tail);
+
+    ASSERT_EQ(bb_a->GetSuccessor(Conditional::Branch::FALLTHROUGH), bb_b);
+    ASSERT_EQ(bb_a->GetSuccessor(Conditional::Branch::BRANCH_TRUE), bb_x);
+    ASSERT_TRUE(bb_b->GetLastInst()->IsUnconditionalJump());
+}
+
+TEST(TestLinearOrder, ProfileLoad)
+{
+    Profile profile{};
+
+    std::stringstream good{ "0 1 100\n1 2 10\n1 3 90\n" };
+    ASSERT_TRUE(profile.Load(good));
+    ASSERT_EQ(profile.GetEdgeCount(1, 3), 90);
+    ASSERT_EQ(profile.GetEdgeCount(1, 2), 10);
+    ASSERT_EQ(profile.GetEdgeCount(2, 1), 0);
+
+    std::stringstream truncated{ "0 1 100\n1 2\n" };
+    ASSERT_FALSE(profile.Load(truncated));
+    ASSERT_TRUE(profile.IsEmpty());
+
+    std::stringstream malformed{ "0 1 hot\n" };
+    ASSERT_FALSE(profile.Load(malformed));
+    ASSERT_TRUE(profile.IsEmpty());
+}
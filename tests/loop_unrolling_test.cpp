@@ -0,0 +1,532 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+
+#include "gtest/gtest.h"
+
+#include <limits>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static std::vector<InstBase*> CollectInsts(Graph* g, isa::inst::Opcode opcode)
+{
+    std::vector<InstBase*> res{};
+    for (auto bb : g->GetPassManager()->GetValidPass<RPO>()->GetBlocks()) {
+        for (auto i = bb->GetFirstPhi(); i != nullptr; i = i->GetNext()) {
+            if (i->GetOpcode() == opcode) {
+                res.push_back(i);
+            }
+        }
+        for (auto i = bb->GetFirstInst(); i != nullptr; i = i->GetNext()) {
+            if (i->GetOpcode() == opcode) {
+                res.push_back(i);
+            }
+        }
+    }
+    return res;
+}
+
+TEST(TestLoopUnrolling, TripCount)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(1, i1)
+            j = PHI(p0, j1)
+            IF_IMM i, 10
+        B:
+            i1 = ADDI i, 2
+            j1 = SUBI j, 1
+        X:
+            RETURN j
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto C0 = b.NewConst(1);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto I1 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::GEQ);
+
+    auto B = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto I3 = b.NewInst<isa::inst::Opcode::SUBI>();
+
+    auto X = b.NewBlock();
+    auto I4 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { C0, START }, { I2, B } });
+    b.SetInputs(I1, { { P0, START }, { I3, B } });
+    b.SetInputs(IF0, I0);
+    b.SetImmediate(IF0, 0, 10);
+    b.SetInputs(I2, I0);
+    b.SetImmediate(I2, 0, 2);
+    b.SetInputs(I3, I1);
+    b.SetImmediate(I3, 0, 1);
+    b.SetInputs(I4, I1);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->GetValidPass<LoopAnalysis>();
+    auto unrolling = g.GetPassManager()->GetPass<LoopUnrolling>();
+    auto trip_count = unrolling->ComputeTripCount(g.GetBasicBlock(H)->GetLoop());
+    ASSERT_TRUE(trip_count.has_value());
+    ASSERT_EQ(trip_count->iv.phi->GetId(), I0);
+    ASSERT_EQ(trip_count->cond, Conditional::Type::L);
+    ASSERT_EQ(trip_count->limit, nullptr);
+    ASSERT_EQ(trip_count->limit_imm, 10);
+    ASSERT_TRUE(trip_count->is_const);
+    // i = 1, 3, 5, 7, 9
+    ASSERT_EQ(trip_count->count, 5);
+}
+
+TEST(TestLoopUnrolling, RuntimeTripCount)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(p0, i1)
+            IF p1, i
+        B:
+            CHECK_ZERO i
+            i1 = SUBI i, 1
+        X:
+            RETURN_VOID
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::L);
+
+    auto B = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto I2 = b.NewInst<isa::inst::Opcode::SUBI>();
+
+    auto X = b.NewBlock();
+    auto I3 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(I0, { { P0, START }, { I2, B } });
+    b.SetInputs(IF0, P1, I0);
+    b.SetInputs(I1, I0);
+    b.SetInputs(I2, I0);
+    b.SetImmediate(I2, 0, 1);
+
+    // p1 < i -> loop
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { X, B });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->GetValidPass<LoopAnalysis>();
+    auto unrolling = g.GetPassManager()->GetPass<LoopUnrolling>();
+    auto trip_count = unrolling->ComputeTripCount(g.GetBasicBlock(H)->GetLoop());
+    ASSERT_TRUE(trip_count.has_value());
+    ASSERT_EQ(trip_count->iv.phi->GetId(), I0);
+    ASSERT_EQ(trip_count->iv.step, -1);
+    ASSERT_EQ(trip_count->cond, Conditional::Type::G);
+    ASSERT_EQ(trip_count->limit->GetId(), P1);
+    ASSERT_FALSE(trip_count->is_const);
+}
+
+TEST(TestLoopUnrolling, FullUnroll)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(0, i1)
+            s = PHI(0, s1)
+            IF_IMM i, 3
+        B:
+            s1 = ADD s, i
+            i1 = ADDI i, 1
+        X:
+            RETURN s
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(0);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto I1 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::GEQ);
+
+    auto B = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I4 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { C0, START }, { I3, B } });
+    b.SetInputs(I1, { { C0, START }, { I2, B } });
+    b.SetInputs(IF0, I0);
+    b.SetImmediate(IF0, 0, 3);
+    b.SetInputs(I2, I1, I0);
+    b.SetInputs(I3, I0);
+    b.SetImmediate(I3, 0, 1);
+    b.SetInputs(I4, I1);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<LoopUnrolling>();
+
+    auto root = g.GetPassManager()->GetValidPass<LoopAnalysis>()->GetRootLoop();
+    ASSERT_TRUE(root->GetInnerLoops().empty());
+    ASSERT_TRUE(CollectInsts(&g, isa::inst::Opcode::IF_IMM).empty());
+    ASSERT_TRUE(CollectInsts(&g, isa::inst::Opcode::PHI).empty());
+
+    auto adds = CollectInsts(&g, isa::inst::Opcode::ADD);
+    ASSERT_EQ(adds.size(), 3);
+    auto incs = CollectInsts(&g, isa::inst::Opcode::ADDI);
+    ASSERT_EQ(incs.size(), 3);
+
+    // s = ((0 + 0) + 1) + 2
+    auto ret = CollectInsts(&g, isa::inst::Opcode::RETURN);
+    ASSERT_EQ(ret.size(), 1);
+    ASSERT_EQ(ret[0]->GetInput(0).GetInst(), adds[2]);
+    ASSERT_EQ(adds[2]->GetInput(0).GetInst(), adds[1]);
+    ASSERT_EQ(adds[2]->GetInput(1).GetInst(), incs[1]);
+    ASSERT_EQ(adds[1]->GetInput(0).GetInst(), adds[0]);
+    ASSERT_EQ(adds[1]->GetInput(1).GetInst(), incs[0]);
+    ASSERT_EQ(adds[0]->GetInput(0).GetInst()->GetId(), C0);
+    ASSERT_EQ(adds[0]->GetInput(1).GetInst()->GetId(), C0);
+    ASSERT_EQ(incs[0]->GetInput(0).GetInst()->GetId(), C0);
+}
+
+TEST(TestLoopUnrolling, PartialUnroll)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(0, i1)
+            s = PHI(0, s1)
+            IF i, p0
+        B:
+            s1 = ADD s, i
+            i1 = ADDI i, 1
+        X:
+            RETURN s
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto C0 = b.NewConst(0);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto I1 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::L);
+
+    auto B = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I4 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { C0, START }, { I3, B } });
+    b.SetInputs(I1, { { C0, START }, { I2, B } });
+    b.SetInputs(IF0, I0, P0);
+    b.SetInputs(I2, I1, I0);
+    b.SetInputs(I3, I0);
+    b.SetImmediate(I3, 0, 1);
+    b.SetInputs(I4, I1);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { X, B });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<LoopUnrolling>();
+
+    auto root = g.GetPassManager()->GetValidPass<LoopAnalysis>()->GetRootLoop();
+    ASSERT_EQ(root->GetInnerLoops().size(), 2);
+
+    auto bb_h = g.GetBasicBlock(H);
+    auto remainder = bb_h->GetLoop();
+    ASSERT_EQ(remainder->GetHeader(), bb_h);
+
+    // main loop precedes the remainder loop
+    auto ifs = CollectInsts(&g, isa::inst::Opcode::IF);
+    ASSERT_EQ(ifs.size(), 2);
+    ASSERT_EQ(ifs[1]->GetId(), IF0);
+    auto guard = ifs[0];
+    auto main_header = guard->GetBasicBlock();
+    ASSERT_TRUE(main_header->IsLoopHeader());
+    auto remainder_pre_header = main_header->GetSuccessor(Conditional::Branch::FALLTHROUGH);
+    ASSERT_EQ(remainder_pre_header, remainder->GetPreHeader());
+
+    // i < max(p0, MIN + 3) - 3
+    int64_t offset = LoopUnrolling::PARTIAL_UNROLL_MAX_FACTOR - 1;
+    ASSERT_EQ(static_cast<isa::inst_type::IF*>(guard)->GetCondition(), Conditional::Type::L);
+    ASSERT_TRUE(guard->GetInput(0).GetInst()->IsPhi());
+    ASSERT_EQ(guard->GetInput(0).GetInst()->GetBasicBlock(), main_header);
+    auto bound = guard->GetInput(1).GetInst();
+    ASSERT_EQ(bound->GetOpcode(), isa::inst::Opcode::SUB);
+    ASSERT_EQ(bound->GetInput(1).GetInst()->GetIntegralConst(), offset);
+    auto clamp = bound->GetInput(0).GetInst();
+    ASSERT_EQ(clamp->GetOpcode(), isa::inst::Opcode::MAX);
+    ASSERT_EQ(clamp->GetInput(0).GetInst()->GetId(), P0);
+    ASSERT_EQ(clamp->GetInput(1).GetInst()->GetIntegralConst(),
+              std::numeric_limits<int64_t>::min() + offset);
+    // bound is computed once, outside of the loops
+    ASSERT_TRUE(clamp->GetBasicBlock()->GetLoop()->IsRoot());
+
+    auto adds = CollectInsts(&g, isa::inst::Opcode::ADD);
+    ASSERT_EQ(adds.size(), LoopUnrolling::PARTIAL_UNROLL_MAX_FACTOR + 1);
+    ASSERT_EQ(CollectInsts(&g, isa::inst::Opcode::PHI).size(), 4);
+
+    // remainder loop starts with values from the main loop
+    for (auto phi = bb_h->GetFirstPhi(); phi != nullptr; phi = phi->GetNext()) {
+        for (const auto& input : phi->GetInputs()) {
+            if (input.GetSourceBB()->GetLoop() != remainder) {
+                ASSERT_TRUE(input.GetInst()->IsPhi());
+                ASSERT_EQ(input.GetInst()->GetBasicBlock(), main_header);
+            }
+        }
+    }
+
+    auto ret = CollectInsts(&g, isa::inst::Opcode::RETURN);
+    ASSERT_EQ(ret[0]->GetInput(0).GetInst()->GetId(), I1);
+}
+
+TEST(TestLoopUnrolling, WrappingTripCount)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(MAX - 1, i1)
+            IF i, MAX
+        B:
+            i1 = ADDI i, 1
+        X:
+            RETURN_VOID
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    static constexpr int64_t MAX = std::numeric_limits<int64_t>::max();
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(MAX - 1);
+    auto C1 = b.NewConst(MAX);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::LEQ);
+
+    auto B = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(I0, { { C0, START }, { I1, B } });
+    b.SetInputs(IF0, I0, C1);
+    b.SetInputs(I1, I0);
+    b.SetImmediate(I1, 0, 1);
+
+    // i <= MAX holds for every i, so the loop never exits
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { X, B });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->GetValidPass<LoopAnalysis>();
+    auto unrolling = g.GetPassManager()->GetPass<LoopUnrolling>();
+    auto trip_count = unrolling->ComputeTripCount(g.GetBasicBlock(H)->GetLoop());
+    ASSERT_TRUE(trip_count.has_value());
+    ASSERT_EQ(trip_count->cond, Conditional::Type::LEQ);
+    ASSERT_FALSE(trip_count->is_const);
+
+    g.GetPassManager()->Run<LoopUnrolling>();
+
+    // loop is not replaced with a finite number of iterations
+    auto root = g.GetPassManager()->GetValidPass<LoopAnalysis>()->GetRootLoop();
+    ASSERT_FALSE(root->GetInnerLoops().empty());
+    ASSERT_NE(g.GetBasicBlock(H), nullptr);
+    ASSERT_EQ(g.GetBasicBlock(H)->GetLastInst()->GetId(), IF0);
+}
+
+TEST(TestLoopUnrolling, PartialUnrollNearLimit)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(p0, i1)
+            IF i, MAX - 1
+        B:
+            i1 = ADDI i, 1
+        X:
+            RETURN i
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    static constexpr int64_t MAX = std::numeric_limits<int64_t>::max();
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto C0 = b.NewConst(MAX - 1);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::L);
+
+    auto B = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { P0, START }, { I1, B } });
+    b.SetInputs(IF0, I0, C0);
+    b.SetInputs(I1, I0);
+    b.SetImmediate(I1, 0, 1);
+    b.SetInputs(I2, I0);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { X, B });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<LoopUnrolling>();
+
+    auto ifs = CollectInsts(&g, isa::inst::Opcode::IF);
+    ASSERT_EQ(ifs.size(), 2);
+    ASSERT_EQ(ifs[1]->GetId(), IF0);
+
+    // i + 3 < MAX - 1 is checked as i < MAX - 4, so i + 3 is never computed and can't wrap
+    auto guard = ifs[0];
+    ASSERT_EQ(static_cast<isa::inst_type::IF*>(guard)->GetCondition(), Conditional::Type::L);
+    ASSERT_TRUE(guard->GetInput(0).GetInst()->IsPhi());
+    ASSERT_EQ(guard->GetInput(1).GetInst()->GetIntegralConst(),
+              MAX - 1 - static_cast<int64_t>(LoopUnrolling::PARTIAL_UNROLL_MAX_FACTOR - 1));
+}
+
+TEST(TestLoopUnrolling, PartialUnrollOverflowingStep)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(p0, i1)
+            IF i, p1
+        B:
+            i1 = ADDI i, 2^62
+        X:
+            RETURN i
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::L);
+
+    auto B = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { P0, START }, { I1, B } });
+    b.SetInputs(IF0, I0, P1);
+    b.SetInputs(I1, I0);
+    b.SetImmediate(I1, 0, static_cast<ImmType>(int64_t{ 1 } << 62));
+    b.SetInputs(I2, I0);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { X, B });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<LoopUnrolling>();
+
+    // (factor - 1) * 2^62 doesn't fit into int64_t, loop is left as is
+    ASSERT_EQ(CollectInsts(&g, isa::inst::Opcode::IF).size(), 1);
+    ASSERT_EQ(CollectInsts(&g, isa::inst::Opcode::ADDI).size(), 1);
+}
+
+#pragma GCC diagnostic pop
@@ -89,17 +89,17 @@ TEST(RegallocTests, LinearScanTest0)
     pass->SetArch<arch::Arch::UNSET>();
     pass->Run();
 
-    CHECK_REGALLOC(C0, REGISTER, 0);
+    CHECK_REGALLOC(C0, REMAT, 0);
     CHECK_REGALLOC(C1, REGISTER, 1);
-    CHECK_REGALLOC(C2, STACK, 1);
+    CHECK_REGALLOC(C2, REMAT, 0);
 
-    CHECK_REGALLOC(PHI0, STACK, 0);
-    CHECK_REGALLOC(PHI1, REGISTER, 1);
+    CHECK_REGALLOC(PHI0, REGISTER, 1);
+    CHECK_REGALLOC(PHI1, REGISTER, 2);
 
-    CHECK_REGALLOC(CMP, REGISTER, 2);
+    CHECK_REGALLOC(CMP, REGISTER, 0);
 
-    CHECK_REGALLOC(I0, REGISTER, 2);
-    CHECK_REGALLOC(I1, REGISTER, 1);
+    CHECK_REGALLOC(I0, REGISTER, 0);
+    CHECK_REGALLOC(I1, REGISTER, 2);
     CHECK_REGALLOC(I2, REGISTER, 0);
 }
 
@@ -168,17 +168,17 @@ TEST(RegallocTests, LinearScanTest1)
     pass->SetArch<arch::Arch::UNSET>();
     pass->Run();
 
-    CHECK_REGALLOC(C0, REGISTER, 0);
+    CHECK_REGALLOC(C0, REMAT, 0);
     CHECK_REGALLOC(C1, REGISTER, 1);
-    CHECK_REGALLOC(C2, STACK, 1);
+    CHECK_REGALLOC(C2, REMAT, 0);
 
-    CHECK_REGALLOC(PHI0, STACK, 0);
-    CHECK_REGALLOC(PHI1, REGISTER, 1);
+    CHECK_REGALLOC(PHI0, REGISTER, 1);
+    CHECK_REGALLOC(PHI1, REGISTER, 2);
 
-    CHECK_REGALLOC(CMP, REGISTER, 2);
+    CHECK_REGALLOC(CMP, REGISTER, 0);
 
-    CHECK_REGALLOC(I0, REGISTER, 2);
-    CHECK_REGALLOC(I1, REGISTER, 1);
+    CHECK_REGALLOC(I0, REGISTER, 0);
+    CHECK_REGALLOC(I1, REGISTER, 2);
     CHECK_REGALLOC(I2, REGISTER, 0);
 }
 
@@ -352,3 +352,317 @@ TEST(RegallocTests, LinearScanTest3)
 
     CHECK_REGALLOC(PHI, REGISTER, 0);
 }
+
+TEST(RegallocTests, LinearScanSpillWeights)
+{
+    /*
+          +-------+
+          | START |
+          +-------+
+            |
+            v
+          +-------+
+          |   A   |
+          +-------+
+            |
+            v
++---+     +-------+
+| E | <-- |   L   | <+
++---+     +-------+  |
+            |        |
+            v        |
+          +-------+  |
+          | BODY  | -+
+          +-------+
+*/
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(1);
+    auto C1 = b.NewConst(10);
+
+    auto A = b.NewBlock();
+    auto COLD = b.NewInst<isa::inst::Opcode::ADD>();
+    auto HOT = b.NewInst<isa::inst::Opcode::MUL>();
+
+    auto L = b.NewBlock();
+    auto PHI = b.NewInst<isa::inst::Opcode::PHI>();
+    auto CMP = b.NewInst<isa::inst::Opcode::SUB>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+
+    auto BODY = b.NewBlock();
+    auto NEXT = b.NewInst<isa::inst::Opcode::ADD>();
+
+    auto E = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto RET = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(COLD, C0, C1);
+    b.SetInputs(HOT, C0, C1);
+
+    b.SetInputs(PHI, { { C0, A }, { NEXT, BODY } });
+    b.SetInputs(CMP, PHI, HOT);
+    b.SetInputs(IF0, CMP, C0);
+
+    b.SetInputs(NEXT, PHI, HOT);
+
+    b.SetInputs(I0, COLD, C1);
+    b.SetInputs(I1, I0, HOT);
+    b.SetInputs(RET, I1);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { L });
+    b.SetSuccessors(L, { BODY, E });
+    b.SetSuccessors(BODY, { L });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto pass = g.GetPassManager()->GetPass<LinearScan>();
+    pass->SetArch<arch::Arch::UNSET>();
+    pass->Run();
+
+    // HOT lives longer than COLD, but it is used in the loop
+    CHECK_REGALLOC(COLD, STACK, 0);
+    CHECK_REGALLOC(HOT, REGISTER, 1);
+}
+
+TEST(RegallocTests, LinearScanRematerialization)
+{
+    /*
+          +-------+
+          | START |
+          +-------+
+            |
+            v
+          +-------+
+          |   A   |
+          +-------+
+            |
+            v
+          +-------+
+          |   B   |
+          +-------+
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+    auto C0 = b.NewConst(1);
+
+    auto A = b.NewBlock();
+    auto ADDI0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto ADDI1 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto I0 = b.NewInst<isa::inst::Opcode::MUL>();
+    auto I1 = b.NewInst<isa::inst::Opcode::MUL>();
+
+    auto B = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I4 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I5 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto RET = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(ADDI0, P0);
+    b.SetInputs(ADDI1, P1);
+    b.SetImmediate(ADDI0, 0, 2);
+    b.SetImmediate(ADDI1, 0, 3);
+    b.SetInputs(I0, P0, P1);
+    b.SetInputs(I1, I0, P1);
+
+    b.SetInputs(I2, I1, C0);
+    b.SetInputs(I3, I2, ADDI0);
+    b.SetInputs(I4, I3, ADDI1);
+    b.SetInputs(I5, I4, P0);
+    b.SetInputs(RET, I5);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto pass = g.GetPassManager()->GetPass<LinearScan>();
+    pass->SetArch<arch::Arch::UNSET>();
+    pass->Run();
+
+    // constant is recomputed at use instead of store and load
+    CHECK_REGALLOC(C0, REMAT, 0);
+    // P0 outlives ADDI0, so ADDI0 is recomputed from it
+    CHECK_REGALLOC(ADDI0, REMAT, 0);
+    // P1 dies before the use of ADDI1, so ADDI1 needs a stack slot
+    CHECK_REGALLOC(ADDI1, STACK, 0);
+}
+
+TEST(RegallocTests, LinearScanRematerializationChain)
+{
+    /*
+          +-------+
+          | START |
+          +-------+
+            |
+            v
+          +-------+
+          |   A   |
+          +-------+
+            |
+            v
+          +-------+
+          |   B   |
+          +-------+
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+    auto P2 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto ADDI0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto ADDI1 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto I0 = b.NewInst<isa::inst::Opcode::MUL>();
+    auto I1 = b.NewInst<isa::inst::Opcode::MUL>();
+
+    auto B = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I4 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I5 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto RET = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(ADDI0, P0);
+    b.SetInputs(ADDI1, ADDI0);
+    b.SetImmediate(ADDI0, 0, 2);
+    b.SetImmediate(ADDI1, 0, 3);
+    b.SetInputs(I0, P1, P2);
+    b.SetInputs(I1, I0, P1);
+
+    b.SetInputs(I2, I1, ADDI0);
+    b.SetInputs(I3, I2, P0);
+    b.SetInputs(I4, I3, P2);
+    b.SetInputs(I5, I4, ADDI1);
+    b.SetInputs(RET, I5);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto pass = g.GetPassManager()->GetPass<LinearScan>();
+    pass->SetArch<arch::Arch::UNSET>();
+    pass->Run();
+
+    // P0 outlives ADDI0, so ADDI0 is recomputed from it
+    CHECK_REGALLOC(ADDI0, REMAT, 0);
+    // ADDI1 is used after P0 dies, so it can't be recomputed from ADDI0
+    auto ranges = pass->GetLiveRanges();
+    auto addi1 = std::find_if(ranges.begin(), ranges.end(), [ADDI1](const auto& r) {
+        return r.inst->GetId() == ADDI1;
+    });
+    ASSERT_NE(addi1, ranges.end());
+    ASSERT_FALSE(addi1->rematerializable);
+    ASSERT_FALSE(addi1->inst->GetLocation().IsRematerialized());
+}
+
+TEST(RegallocTests, LinearScanRematerializedPhiInputs)
+{
+    /*
+          +-------+
+          | START |
+          +-------+
+            |
+            v
+          +-------+
+          |   A   |
+          +-------+
+           |     |
+           v     v
+       +---+     +---+
+       | B |     | C |
+       +---+     +---+
+           |     |
+           v     v
+          +-------+
+          |   D   |
+          +-------+
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto C0 = b.NewConst(1);
+    auto C1 = b.NewConst(2);
+    auto C2 = b.NewConst(3);
+    auto C3 = b.NewConst(4);
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+
+    auto B = b.NewBlock();
+    auto C = b.NewBlock();
+
+    auto D = b.NewBlock();
+    auto PHI0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto PHI1 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto RET = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(IF0, P0);
+    b.SetInputs(PHI0, { { C0, B }, { C2, C } });
+    b.SetInputs(PHI1, { { C1, B }, { C3, C } });
+    b.SetInputs(I0, PHI0, PHI1);
+    b.SetInputs(I1, I0, P0);
+    b.SetInputs(RET, I1);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+    b.SetSuccessors(B, { D });
+    b.SetSuccessors(C, { D });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto pass = g.GetPassManager()->GetPass<LinearScan>();
+    pass->SetArch<arch::Arch::UNSET>();
+    pass->Run();
+
+    // both constants are recomputed, so moves in C differ only by the value
+    CHECK_REGALLOC(C2, REMAT, 0);
+    CHECK_REGALLOC(C3, REMAT, 0);
+
+    auto bb_c = g.GetBasicBlock(C);
+    auto bb_d = g.GetBasicBlock(D);
+    auto phi0 = bb_d->GetFirstPhi();
+    auto phi1 = phi0->GetNext();
+    ASSERT_EQ(phi0->GetInput(1).GetSourceBB(), bb_c);
+    ASSERT_EQ(phi1->GetInput(1).GetSourceBB(), bb_c);
+
+    auto move_map = pass->GetMoveMap();
+    ASSERT_EQ(move_map.count(bb_c), 1);
+    const auto& moves = move_map.at(bb_c);
+    ASSERT_EQ(moves.size(), 2);
+    ASSERT_EQ(moves[0].input, phi0->GetInput(1).GetInst());
+    ASSERT_EQ(moves[0].from, Location(Location::Where::REMAT, 0));
+    ASSERT_EQ(moves[0].to, phi0->GetLocation());
+    ASSERT_EQ(moves[1].input, phi1->GetInput(1).GetInst());
+    ASSERT_EQ(moves[1].from, Location(Location::Where::REMAT, 0));
+    ASSERT_EQ(moves[1].to, phi1->GetLocation());
+    ASSERT_NE(phi0->GetLocation(), phi1->GetLocation());
+}
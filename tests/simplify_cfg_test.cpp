@@ -0,0 +1,449 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+
+#include "gtest/gtest.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static size_t CountBlocks(Graph* g)
+{
+    return g->GetPassManager()->GetValidPass<RPO>()->GetBlocks().size();
+}
+
+TEST(TestSimplifyCFG, FoldConstantBranch)
+{
+    /*
+        START -> A -> B
+                 |
+                 v
+                 C
+
+        A:
+            IF 1, 2, L -> C
+        B:
+            RETURN P0
+        C:
+            RETURN P1
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+    auto C1 = b.NewConst(1);
+    auto C2 = b.NewConst(2);
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::L);
+    auto B = b.NewBlock();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+    auto C = b.NewBlock();
+    auto R1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(IF0, C1, C2);
+    b.SetInputs(R0, P0);
+    b.SetInputs(R1, P1);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto c1 = g.GetStartBasicBlock()->GetLastInst()->GetPrev();
+    ASSERT_EQ(c1->GetNumUsers(), 1);
+
+    g.GetPassManager()->Run<SimplifyCFG>();
+
+    // A is merged with C, B is removed
+    ASSERT_EQ(CountBlocks(&g), 2);
+    auto bb_a = g.GetBasicBlock(A);
+    ASSERT_EQ(bb_a->GetNumSuccessors(), 0);
+    ASSERT_EQ(g.GetBasicBlock(B), nullptr);
+    ASSERT_EQ(g.GetBasicBlock(C), nullptr);
+
+    auto ret = bb_a->GetFirstInst();
+    ASSERT_EQ(ret->GetOpcode(), isa::inst::Opcode::RETURN);
+    ASSERT_EQ(ret->GetBasicBlock(), bb_a);
+    ASSERT_EQ(ret->GetNext(), nullptr);
+    ASSERT_EQ(ret->GetInput(0).GetInst()->GetId(), P1);
+    ASSERT_EQ(c1->GetNumUsers(), 0);
+}
+
+TEST(TestSimplifyCFG, DiamondToMin)
+{
+    /*
+        START -> A -> F -> J
+                 |         ^
+                 v         |
+                 T --------+
+
+        A:
+            IF P0, P1, L -> T
+        J:
+            x = PHI(P0 from T, P1 from F)
+            y = PHI(P1 from T, P0 from F)
+            z = SUB x, y
+            RETURN z
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::L);
+    auto F = b.NewBlock();
+    auto T = b.NewBlock();
+    auto J = b.NewBlock();
+    auto X = b.NewInst<isa::inst::Opcode::PHI>();
+    auto Y = b.NewInst<isa::inst::Opcode::PHI>();
+    auto Z = b.NewInst<isa::inst::Opcode::SUB>();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(IF0, P0, P1);
+    b.SetInputs(X, { { P0, T }, { P1, F } });
+    b.SetInputs(Y, { { P1, T }, { P0, F } });
+    b.SetType(X, InstBase::DataType::INT);
+    b.SetType(Y, InstBase::DataType::INT);
+    b.SetInputs(Z, X, Y);
+    b.SetInputs(R0, Z);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { F, T });
+    b.SetSuccessors(F, { J });
+    b.SetSuccessors(T, { J });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<SimplifyCFG>();
+
+    ASSERT_EQ(CountBlocks(&g), 2);
+    auto bb_a = g.GetBasicBlock(A);
+    ASSERT_EQ(bb_a->GetFirstPhi(), nullptr);
+
+    auto p0 = g.GetStartBasicBlock()->GetFirstInst();
+    auto p1 = p0->GetNext();
+
+    auto min = bb_a->GetFirstInst();
+    ASSERT_EQ(min->GetOpcode(), isa::inst::Opcode::MIN);
+    ASSERT_EQ(min->GetInput(0).GetInst(), p0);
+    ASSERT_EQ(min->GetInput(1).GetInst(), p1);
+
+    auto max = min->GetNext();
+    ASSERT_EQ(max->GetOpcode(), isa::inst::Opcode::MAX);
+    ASSERT_EQ(max->GetInput(0).GetInst(), p0);
+    ASSERT_EQ(max->GetInput(1).GetInst(), p1);
+
+    auto sub = max->GetNext();
+    ASSERT_EQ(sub->GetOpcode(), isa::inst::Opcode::SUB);
+    ASSERT_EQ(sub->GetInput(0).GetInst(), min);
+    ASSERT_EQ(sub->GetInput(1).GetInst(), max);
+    ASSERT_EQ(sub->GetNext()->GetOpcode(), isa::inst::Opcode::RETURN);
+    ASSERT_EQ(bb_a->GetLastInst(), sub->GetNext());
+
+    // comparison is not used anymore
+    ASSERT_EQ(p0->GetNumUsers(), 2);
+    ASSERT_EQ(p1->GetNumUsers(), 2);
+}
+
+TEST(TestSimplifyCFG, FloatDiamondIsKept)
+{
+    /*
+        START -> A -> F -> J
+                 |         ^
+                 v         |
+                 T --------+
+
+        A:
+            IF P0, P1, L -> T
+        J:
+            x = PHI(P0 from T, P1 from F)
+            RETURN x
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::L);
+    auto F = b.NewBlock();
+    auto T = b.NewBlock();
+    auto J = b.NewBlock();
+    auto X = b.NewInst<isa::inst::Opcode::PHI>();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetType(P0, InstBase::DataType::DOUBLE);
+    b.SetType(P1, InstBase::DataType::DOUBLE);
+    b.SetInputs(IF0, P0, P1);
+    b.SetInputs(X, { { P0, T }, { P1, F } });
+    b.SetType(X, InstBase::DataType::DOUBLE);
+    b.SetInputs(R0, X);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { F, T });
+    b.SetSuccessors(F, { J });
+    b.SetSuccessors(T, { J });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<SimplifyCFG>();
+
+    // MIN differs from the comparison for NaN and signed zeros, so the phi stays
+    auto bb_j = g.GetBasicBlock(J);
+    ASSERT_NE(bb_j, nullptr);
+    ASSERT_EQ(bb_j->GetFirstPhi()->GetId(), X);
+    ASSERT_EQ(g.GetBasicBlock(A)->GetLastInst()->GetId(), IF0);
+}
+
+TEST(TestSimplifyCFG, TriangleToMaxImm)
+{
+    /*
+        START -> A -> F -> J
+                 |         ^
+                 +---------+
+
+        A:
+            IF_IMM P0, 10, G -> J
+        J:
+            x = PHI(P0 from A, 10 from F)
+            RETURN x
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto C10 = b.NewConst(10);
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::G);
+    auto F = b.NewBlock();
+    auto J = b.NewBlock();
+    auto X = b.NewInst<isa::inst::Opcode::PHI>();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(IF0, P0);
+    b.SetImmediate(IF0, 0, 10);
+    b.SetInputs(X, { { P0, A }, { C10, F } });
+    b.SetType(X, InstBase::DataType::INT);
+    b.SetInputs(R0, X);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { F, J });
+    b.SetSuccessors(F, { J });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<SimplifyCFG>();
+
+    ASSERT_EQ(CountBlocks(&g), 2);
+    auto bb_a = g.GetBasicBlock(A);
+
+    auto max = bb_a->GetFirstInst();
+    ASSERT_EQ(max->GetOpcode(), isa::inst::Opcode::MAXI);
+    ASSERT_EQ(max->GetInput(0).GetInst(), g.GetStartBasicBlock()->GetFirstInst());
+    using BinImmT = isa::inst::Inst<isa::inst::Opcode::MAXI>::Type;
+    ASSERT_EQ(static_cast<int64_t>(static_cast<BinImmT*>(max)->GetImm(0)), 10);
+
+    auto ret = max->GetNext();
+    ASSERT_EQ(ret->GetOpcode(), isa::inst::Opcode::RETURN);
+    ASSERT_EQ(ret->GetInput(0).GetInst(), max);
+}
+
+TEST(TestSimplifyCFG, HoistCommonInsts)
+{
+    /*
+        START -> A -> F
+                 |
+                 v
+                 T
+
+        A:
+            IF P0, P1, EQ -> T
+        T:
+            a = ADD P0, P1
+            RETURN a
+        F:
+            b = ADD P0, P1
+            c = MUL b, b
+            RETURN c
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::EQ);
+    auto T = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+    auto F = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I2 = b.NewInst<isa::inst::Opcode::MUL>();
+    auto R1 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(IF0, P0, P1);
+    b.SetInputs(I0, P0, P1);
+    b.SetInputs(R0, I0);
+    b.SetInputs(I1, P0, P1);
+    b.SetInputs(I2, I1, I1);
+    b.SetInputs(R1, I2);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { F, T });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<SimplifyCFG>();
+
+    ASSERT_EQ(CountBlocks(&g), 4);
+    auto bb_a = g.GetBasicBlock(A);
+    auto bb_t = g.GetBasicBlock(T);
+    auto bb_f = g.GetBasicBlock(F);
+
+    auto add = bb_a->GetFirstInst();
+    ASSERT_EQ(add->GetOpcode(), isa::inst::Opcode::ADD);
+    ASSERT_EQ(add->GetNext(), bb_a->GetLastInst());
+    ASSERT_EQ(add->GetNumUsers(), 3);
+
+    auto r0 = bb_t->GetFirstInst();
+    ASSERT_EQ(r0->GetOpcode(), isa::inst::Opcode::RETURN);
+    ASSERT_EQ(r0->GetInput(0).GetInst(), add);
+
+    auto mul = bb_f->GetFirstInst();
+    ASSERT_EQ(mul->GetOpcode(), isa::inst::Opcode::MUL);
+    ASSERT_EQ(mul->GetInput(0).GetInst(), add);
+    ASSERT_EQ(mul->GetInput(1).GetInst(), add);
+}
+
+TEST(TestSimplifyCFG, TrivialPhi)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            s = PHI(P0 from START, s from B)
+            IF_IMM P1, 0, EQ -> X
+        X:
+            RETURN s
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+
+    auto H = b.NewBlock();
+    auto S = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    auto B = b.NewBlock();
+    auto X = b.NewBlock();
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(S, { { P0, START }, { S, B } });
+    b.SetInputs(IF0, P1);
+    b.SetImmediate(IF0, 0, 0);
+    b.SetInputs(R0, S);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<SimplifyCFG>();
+
+    auto bb_h = g.GetBasicBlock(H);
+    ASSERT_EQ(bb_h->GetFirstPhi(), nullptr);
+    ASSERT_EQ(bb_h->GetNumPredecessors(), 2);
+
+    auto p0 = g.GetStartBasicBlock()->GetFirstInst();
+    auto ret = g.GetBasicBlock(X)->GetFirstInst();
+    ASSERT_EQ(ret->GetInput(0).GetInst(), p0);
+    ASSERT_EQ(p0->GetNumUsers(), 1);
+}
+
+TEST(TestSimplifyCFG, MergeChain)
+{
+    /*
+        START -> B_0 -> B_1 -> ... -> B_n
+
+        B_i:
+            x_i = ADDI x_(i-1), 1
+        B_n:
+            RETURN x_n
+    */
+    static constexpr size_t CHAIN_LENGTH = 1000;
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto prev_bb = START;
+    auto prev = P0;
+    std::vector<IdType> blocks{};
+    for (size_t i = 0; i < CHAIN_LENGTH; ++i) {
+        auto bb = b.NewBlock();
+        auto inst = b.NewInst<isa::inst::Opcode::ADDI>();
+        b.SetInputs(inst, prev);
+        b.SetImmediate(inst, 0, 1);
+        b.SetSuccessors(prev_bb, { bb });
+        blocks.push_back(bb);
+        prev_bb = bb;
+        prev = inst;
+    }
+    auto R0 = b.NewInst<isa::inst::Opcode::RETURN>();
+    b.SetInputs(R0, prev);
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<SimplifyCFG>();
+
+    // the whole chain is merged into the first block in one sweep
+    ASSERT_EQ(CountBlocks(&g), 2);
+    auto bb = g.GetBasicBlock(blocks.front());
+    for (size_t i = 1; i < CHAIN_LENGTH; ++i) {
+        ASSERT_EQ(g.GetBasicBlock(blocks[i]), nullptr);
+    }
+
+    size_t count = 0;
+    for (auto inst = bb->GetFirstInst(); inst != nullptr; inst = inst->GetNext()) {
+        ASSERT_EQ(inst->GetBasicBlock(), bb);
+        ++count;
+    }
+    ASSERT_EQ(count, CHAIN_LENGTH + 1);
+    ASSERT_EQ(bb->GetLastInst()->GetId(), R0);
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,94 @@
+#include "utils/small_vector.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <vector>
+
+TEST(SmallVectorTest, Inline)
+{
+    SmallVector<int, 2> v{};
+    ASSERT_TRUE(v.empty());
+
+    v.push_back(1);
+    v.emplace_back(2);
+    ASSERT_TRUE(v.IsInline());
+    ASSERT_EQ(v.size(), 2);
+    ASSERT_EQ(v[0], 1);
+    ASSERT_EQ(v[1], 2);
+
+    v.resize(1);
+    ASSERT_EQ(v.size(), 1);
+    v.resize(2);
+    ASSERT_EQ(v[1], 0);
+    ASSERT_TRUE(v.IsInline());
+}
+
+TEST(SmallVectorTest, Heap)
+{
+    SmallVector<int, 2> v{};
+    for (int i = 0; i < 5; ++i) {
+        v.push_back(i);
+    }
+    ASSERT_FALSE(v.IsInline());
+    ASSERT_EQ(v.size(), 5);
+    ASSERT_EQ(std::vector<int>(v.begin(), v.end()), std::vector<int>({ 0, 1, 2, 3, 4 }));
+
+    auto copy = v;
+    v.clear();
+    ASSERT_TRUE(v.empty());
+    ASSERT_EQ(copy.size(), 5);
+    ASSERT_EQ(copy[4], 4);
+}
+
+TEST(SmallVectorTest, Erase)
+{
+    SmallVector<int, 4> v{};
+    for (int i = 0; i < 4; ++i) {
+        v.push_back(i);
+    }
+    v.erase(std::remove_if(v.begin(), v.end(), [](int i) { return i % 2 == 0; }), v.end());
+    ASSERT_TRUE(v.IsInline());
+    ASSERT_EQ(std::vector<int>(v.begin(), v.end()), std::vector<int>({ 1, 3 }));
+
+    for (int i = 4; i < 8; ++i) {
+        v.push_back(i);
+    }
+    ASSERT_FALSE(v.IsInline());
+    auto it = v.erase(v.begin(), v.begin() + 2);
+    ASSERT_EQ(*it, 4);
+    ASSERT_EQ(std::vector<int>(v.begin(), v.end()), std::vector<int>({ 4, 5, 6, 7 }));
+}
+
+TEST(SmallVectorTest, CopyMove)
+{
+    // inline elements share the storage with the heap pointer
+    ASSERT_EQ(sizeof(SmallVector<void*, 2>), 2 * sizeof(void*) + 2 * sizeof(uint32_t));
+
+    SmallVector<int, 2> small{};
+    small.push_back(1);
+    SmallVector<int, 2> large{};
+    for (int i = 0; i < 3; ++i) {
+        large.push_back(i);
+    }
+
+    auto small_copy = small;
+    ASSERT_TRUE(small_copy.IsInline());
+    ASSERT_EQ(small_copy.size(), 1);
+    ASSERT_EQ(small_copy[0], 1);
+
+    auto large_moved = std::move(large);
+    ASSERT_FALSE(large_moved.IsInline());
+    ASSERT_EQ(std::vector<int>(large_moved.begin(), large_moved.end()),
+              std::vector<int>({ 0, 1, 2 }));
+
+    // heap vector is replaced with the inline one and back
+    large_moved = small_copy;
+    ASSERT_TRUE(large_moved.IsInline());
+    ASSERT_EQ(large_moved.size(), 1);
+    small_copy = std::move(large_moved);
+    ASSERT_EQ(small_copy[0], 1);
+
+    small.push_back(small[0]);
+    small.push_back(small[1]);
+    ASSERT_EQ(std::vector<int>(small.begin(), small.end()), std::vector<int>({ 1, 1, 1 }));
+}
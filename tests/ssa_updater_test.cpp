@@ -0,0 +1,269 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+#include "ssa_updater.h"
+
+#include "gtest/gtest.h"
+
+#include <set>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static std::set<std::pair<InstBase*, BasicBlock*> > GetPhiInputs(InstBase* phi)
+{
+    std::set<std::pair<InstBase*, BasicBlock*> > res{};
+    for (const auto& input : phi->GetInputs()) {
+        res.insert({ input.GetInst(), input.GetSourceBB() });
+    }
+    return res;
+}
+
+TEST(TestSSAUpdater, Diamond)
+{
+    /*
+        START -> A -> B -> D -> E
+                 |         ^
+                 v         |
+                 C --------+
+
+        A:
+            x = ADDI P0, 1
+            IF_IMM x, 0
+        C:
+            x2 = ADDI P0, 5   <- new definition of x
+        D:
+        E:
+            RETURN x
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto A = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    auto B = b.NewBlock();
+    auto C = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto D = b.NewBlock();
+    auto E = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, P0);
+    b.SetImmediate(I0, 0, 1);
+    b.SetInputs(IF0, I0);
+    b.SetInputs(I1, P0);
+    b.SetImmediate(I1, 0, 5);
+    b.SetInputs(I2, I0);
+
+    b.SetSuccessors(START, { A });
+    b.SetSuccessors(A, { B, C });
+    b.SetSuccessors(B, { D });
+    b.SetSuccessors(C, { D });
+    b.SetSuccessors(D, { E });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto bb_a = g.GetBasicBlock(A);
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_c = g.GetBasicBlock(C);
+    auto bb_d = g.GetBasicBlock(D);
+    auto bb_e = g.GetBasicBlock(E);
+    auto x = bb_a->GetFirstInst();
+    auto if0 = x->GetNext();
+    auto x2 = bb_c->GetFirstInst();
+    auto ret = bb_e->GetFirstInst();
+
+    SSAUpdater updater{ InstBase::DataType::INT };
+    updater.AddDefinition(bb_a, x);
+    updater.AddDefinition(bb_c, x2);
+    updater.RewriteUses(x);
+
+    // use in A is reached only by x
+    ASSERT_EQ(if0->GetInput(0).GetInst(), x);
+
+    auto phi = bb_d->GetFirstPhi();
+    ASSERT_NE(phi, nullptr);
+    ASSERT_EQ(phi->GetNext(), nullptr);
+    ASSERT_EQ(phi->GetDataType(), InstBase::DataType::INT);
+    ASSERT_EQ(GetPhiInputs(phi), (std::set<std::pair<InstBase*, BasicBlock*> >{
+                                     { x, bb_b }, { x2, bb_c } }));
+    ASSERT_EQ(updater.GetInsertedPhis(), std::vector<InstBase*>{ phi });
+
+    ASSERT_EQ(ret->GetInput(0).GetInst(), phi);
+    ASSERT_EQ(phi->GetNumUsers(), 1);
+    ASSERT_EQ(x->GetNumUsers(), 2);
+    ASSERT_EQ(x2->GetNumUsers(), 1);
+
+    ASSERT_EQ(updater.GetValueAtEntry(bb_e), phi);
+    ASSERT_EQ(updater.GetValueAtEnd(bb_b), x);
+}
+
+TEST(TestSSAUpdater, Loop)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto H = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    auto B = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto X = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(IF0, P0);
+    b.SetInputs(I0, P0);
+    b.SetImmediate(I0, 0, 1);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto bb_start = g.GetStartBasicBlock();
+    auto bb_h = g.GetBasicBlock(H);
+    auto bb_b = g.GetBasicBlock(B);
+    auto bb_x = g.GetBasicBlock(X);
+    auto p0 = bb_start->GetFirstInst();
+    auto i0 = bb_b->GetFirstInst();
+
+    // value is not redefined in the loop, phi in header is trivial
+    {
+        SSAUpdater updater{ InstBase::DataType::INT };
+        updater.AddDefinition(bb_start, p0);
+        ASSERT_EQ(updater.GetValueAtEntry(bb_x), p0);
+        ASSERT_EQ(updater.GetValueAtEntry(bb_b), p0);
+        ASSERT_EQ(bb_h->GetFirstPhi(), nullptr);
+        ASSERT_TRUE(updater.GetInsertedPhis().empty());
+    }
+
+    // value is redefined on the back edge
+    {
+        SSAUpdater updater{ InstBase::DataType::INT };
+        updater.AddDefinition(bb_start, p0);
+        updater.AddDefinition(bb_b, i0);
+
+        auto phi = updater.GetValueAtEntry(bb_x);
+        ASSERT_TRUE(phi->IsPhi());
+        ASSERT_EQ(phi->GetBasicBlock(), bb_h);
+        ASSERT_EQ(GetPhiInputs(phi), (std::set<std::pair<InstBase*, BasicBlock*> >{
+                                         { p0, bb_start }, { i0, bb_b } }));
+        ASSERT_EQ(updater.GetValueAtEntry(bb_b), phi);
+    }
+}
+
+TEST(TestSSAUpdater, TrivialPhiChain)
+{
+    /*
+        START -> D -> Y <-> X <-
+                            |  |
+                            ----
+    */
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto D = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    auto Y = b.NewBlock();
+    auto X = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+
+    b.SetInputs(I0, P0);
+    b.SetImmediate(I0, 0, 1);
+    b.SetInputs(IF0, P0);
+
+    b.SetSuccessors(START, { D });
+    b.SetSuccessors(D, { Y });
+    b.SetSuccessors(Y, { X });
+    b.SetSuccessors(X, { X, Y });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto bb_d = g.GetBasicBlock(D);
+    auto bb_y = g.GetBasicBlock(Y);
+    auto bb_x = g.GetBasicBlock(X);
+    auto i0 = bb_d->GetFirstInst();
+
+    // phi in X is removed first, then phi in Y, that used it, becomes trivial and is removed too
+    SSAUpdater updater{ InstBase::DataType::INT };
+    updater.AddDefinition(bb_d, i0);
+    ASSERT_EQ(updater.GetValueAtEntry(bb_x), i0);
+    ASSERT_EQ(updater.GetValueAtEntry(bb_y), i0);
+    ASSERT_EQ(updater.GetValueAtEnd(bb_x), i0);
+    ASSERT_EQ(bb_x->GetFirstPhi(), nullptr);
+    ASSERT_EQ(bb_y->GetFirstPhi(), nullptr);
+    ASSERT_TRUE(updater.GetInsertedPhis().empty());
+    ASSERT_EQ(i0->GetNumUsers(), 0);
+}
+
+TEST(TestSSAUpdater, LongChain)
+{
+    /*
+        START -> D -> B_1 -> ... -> B_n -> H <-> L
+    */
+    static constexpr size_t CHAIN_LENGTH = 100000;
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+
+    auto D = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::ADDI>();
+    b.SetInputs(I0, P0);
+    b.SetImmediate(I0, 0, 1);
+    b.SetSuccessors(START, { D });
+
+    auto prev = D;
+    for (size_t i = 0; i < CHAIN_LENGTH; ++i) {
+        auto bb = b.NewBlock();
+        b.SetSuccessors(prev, { bb });
+        prev = bb;
+    }
+
+    auto H = b.NewBlock();
+    auto L = b.NewBlock();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::EQ);
+    b.SetInputs(IF0, P0);
+    b.SetSuccessors(prev, { H });
+    b.SetSuccessors(H, { L });
+    b.SetSuccessors(L, { H, L });
+
+    // checks are skipped, they walk the graph recursively
+    b.ConstructCFG();
+    b.ConstructDFG();
+
+    auto i0 = g.GetBasicBlock(D)->GetFirstInst();
+
+    // value is looked up through the whole chain without recursion
+    SSAUpdater updater{ InstBase::DataType::INT };
+    updater.AddDefinition(g.GetBasicBlock(D), i0);
+    ASSERT_EQ(updater.GetValueAtEnd(g.GetBasicBlock(L)), i0);
+    ASSERT_EQ(updater.GetValueAtEntry(g.GetBasicBlock(prev)), i0);
+    ASSERT_TRUE(updater.GetInsertedPhis().empty());
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,462 @@
+#include "bb.h"
+#include "graph.h"
+#include "graph_builder.h"
+
+#include "gtest/gtest.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+static std::vector<InstBase*> CollectInsts(BasicBlock* bb)
+{
+    std::vector<InstBase*> res{};
+    for (auto i = bb->GetFirstInst(); i != nullptr; i = i->GetNext()) {
+        res.push_back(i);
+    }
+    return res;
+}
+
+static std::vector<InstBase*> CollectPhis(BasicBlock* bb)
+{
+    std::vector<InstBase*> res{};
+    for (auto i = bb->GetFirstPhi(); i != nullptr; i = i->GetNext()) {
+        res.push_back(i);
+    }
+    return res;
+}
+
+static InstBase* GetPhiInput(InstBase* phi, BasicBlock* bb)
+{
+    for (const auto& input : phi->GetInputs()) {
+        if (input.GetSourceBB() == bb) {
+            return input.GetInst();
+        }
+    }
+    return nullptr;
+}
+
+TEST(TestStrengthReduction, InductionVariables)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(0, i1)
+            IF_IMM i, 10
+        B:
+            j = MULI i, 4
+            k = SHLI i, 3
+            l = ADD j, k
+            i1 = ADDI i, 1
+        X:
+            RETURN i
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(0);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::GEQ);
+
+    auto B = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::MULI>();
+    auto I2 = b.NewInst<isa::inst::Opcode::SHLI>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I4 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I5 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { C0, START }, { I4, B } });
+    b.SetInputs(IF0, I0);
+    b.SetImmediate(IF0, 0, 10);
+    b.SetInputs(I1, I0);
+    b.SetImmediate(I1, 0, 4);
+    b.SetInputs(I2, I0);
+    b.SetImmediate(I2, 0, 3);
+    b.SetInputs(I3, I1, I2);
+    b.SetInputs(I4, I0);
+    b.SetImmediate(I4, 0, 1);
+    b.SetInputs(I5, I0);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    auto ivs = g.GetPassManager()->GetValidPass<InductionVariableAnalysis>();
+    auto loop = g.GetBasicBlock(H)->GetLoop();
+
+    auto basic = ivs->GetBasicInductionVariables(loop);
+    ASSERT_EQ(basic.size(), 1);
+    ASSERT_EQ(basic[0].phi->GetId(), I0);
+    ASSERT_EQ(basic[0].update->GetId(), I4);
+    ASSERT_EQ(basic[0].init->GetId(), C0);
+    ASSERT_EQ(basic[0].step, 1);
+    ASSERT_NE(ivs->GetBasicInductionVariable(basic[0].phi), nullptr);
+
+    auto derived = ivs->GetDerivedInductionVariables(loop);
+    ASSERT_EQ(derived.size(), 2);
+    std::set<std::pair<IdType, int64_t> > res{};
+    for (const auto& div : derived) {
+        ASSERT_EQ(div.base->GetId(), I0);
+        res.insert({ div.inst->GetId(), div.scale });
+    }
+    std::set<std::pair<IdType, int64_t> > expected{ { I1, 4 }, { I2, 8 } };
+    ASSERT_EQ(res, expected);
+
+    ASSERT_EQ(ivs->GetBasicInductionVariables(g.GetPassManager()->GetValidPass<LoopAnalysis>()
+                                                  ->GetRootLoop())
+                  .size(),
+              0);
+}
+
+TEST(TestStrengthReduction, ReduceMultiplication)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(0, i1)
+            s = PHI(0, s1)
+            IF_IMM i, 10
+        B:
+            j = MULI i, 4
+            s1 = ADD s, j
+            i1 = ADDI i, 1
+        X:
+            RETURN s
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(0);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto I1 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::GEQ);
+
+    auto B = b.NewBlock();
+    auto I2 = b.NewInst<isa::inst::Opcode::MULI>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADD>();
+    auto I4 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I5 = b.NewInst<isa::inst::Opcode::RETURN>();
+
+    b.SetInputs(I0, { { C0, START }, { I4, B } });
+    b.SetInputs(I1, { { C0, START }, { I3, B } });
+    b.SetInputs(IF0, I0);
+    b.SetImmediate(IF0, 0, 10);
+    b.SetInputs(I2, I0);
+    b.SetImmediate(I2, 0, 4);
+    b.SetInputs(I3, I1, I2);
+    b.SetInputs(I4, I0);
+    b.SetImmediate(I4, 0, 1);
+    b.SetInputs(I5, I1);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<StrengthReduction>();
+    g.GetPassManager()->Run<DCE>();
+
+    auto bb_h = g.GetBasicBlock(H);
+    auto bb_b = g.GetBasicBlock(B);
+    auto pre_header = bb_h->GetLoop()->GetPreHeader();
+
+    // multiplication and the original induction variable are gone
+    auto phis = CollectPhis(bb_h);
+    ASSERT_EQ(phis.size(), 2);
+    ASSERT_EQ(phis[0]->GetId(), I1);
+    auto r = phis[1];
+
+    auto insts = CollectInsts(bb_b);
+    ASSERT_EQ(insts.size(), 2);
+    ASSERT_EQ(insts[0]->GetId(), I3);
+    auto r1 = insts[1];
+    ASSERT_EQ(r1->GetOpcode(), isa::inst::Opcode::ADDI);
+    ASSERT_EQ(r1->GetInput(0).GetInst(), r);
+    ASSERT_EQ(static_cast<isa::inst_type::BIN_IMM*>(r1)->GetImm(0), 4);
+
+    ASSERT_EQ(insts[0]->GetInput(0).GetInst()->GetId(), I1);
+    ASSERT_EQ(insts[0]->GetInput(1).GetInst(), r);
+
+    auto init = GetPhiInput(r, pre_header);
+    ASSERT_NE(init, nullptr);
+    ASSERT_TRUE(init->IsConst());
+    ASSERT_EQ(static_cast<isa::inst_type::CONST*>(init)->GetValInt(), 0);
+    ASSERT_EQ(GetPhiInput(r, bb_b), r1);
+
+    // exit condition is rewritten to use reduced variable
+    auto if0 = bb_h->GetLastInst();
+    ASSERT_EQ(if0->GetId(), IF0);
+    ASSERT_EQ(if0->GetInput(0).GetInst(), r);
+    ASSERT_EQ(static_cast<isa::inst_type::IF_IMM*>(if0)->GetImm(0), 40);
+}
+
+TEST(TestStrengthReduction, ReduceWithInvariantLimit)
+{
+    /*
+        START -> H <-> B
+                 |
+                 v
+                 X
+
+        H:
+            i = PHI(p0, i1)
+            IF i, p1
+        B:
+            j = MUL 3, i
+            CHECK_ZERO j
+            i1 = SUBI i, 2
+        X:
+            RETURN_VOID
+    */
+
+    Graph g;
+    GraphBuilder b(&g);
+
+    auto START = Graph::BB_START_ID;
+    auto P0 = b.NewParameter();
+    auto P1 = b.NewParameter();
+    auto C0 = b.NewConst(3);
+
+    auto H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF>(Conditional::Type::LEQ);
+
+    auto B = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::MUL>();
+    auto I2 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto I3 = b.NewInst<isa::inst::Opcode::SUBI>();
+
+    auto X = b.NewBlock();
+    auto I4 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(I0, { { P0, START }, { I3, B } });
+    b.SetInputs(IF0, I0, P1);
+    b.SetInputs(I1, C0, I0);
+    b.SetInputs(I2, I1);
+    b.SetInputs(I3, I0);
+    b.SetImmediate(I3, 0, 2);
+
+    b.SetSuccessors(START, { H });
+    b.SetSuccessors(H, { B, X });
+    b.SetSuccessors(B, { H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    ASSERT_TRUE(b.RunChecks());
+
+    g.GetPassManager()->Run<StrengthReduction>();
+    g.GetPassManager()->Run<DCE>();
+
+    auto bb_h = g.GetBasicBlock(H);
+    auto bb_b = g.GetBasicBlock(B);
+    auto pre_header = bb_h->GetLoop()->GetPreHeader();
+
+    // range of i is unknown, so the exit condition is kept
+    auto phis = CollectPhis(bb_h);
+    ASSERT_EQ(phis.size(), 2);
+    ASSERT_EQ(phis[0]->GetId(), I0);
+    auto r = phis[1];
+
+    auto insts = CollectInsts(bb_b);
+    ASSERT_EQ(insts.size(), 3);
+    ASSERT_EQ(insts[0]->GetId(), I2);
+    ASSERT_EQ(insts[0]->GetInput(0).GetInst(), r);
+    ASSERT_EQ(insts[1]->GetId(), I3);
+    auto r1 = insts[2];
+    ASSERT_EQ(r1->GetOpcode(), isa::inst::Opcode::ADDI);
+    ASSERT_EQ(static_cast<isa::inst_type::BIN_IMM*>(r1)->GetImm(0), -6);
+
+    // initial value is scaled in pre-header
+    auto pre_insts = CollectInsts(pre_header);
+    ASSERT_EQ(pre_insts.size(), 1);
+    ASSERT_EQ(pre_insts[0]->GetOpcode(), isa::inst::Opcode::MULI);
+    ASSERT_EQ(static_cast<isa::inst_type::BIN_IMM*>(pre_insts[0])->GetImm(0), 3);
+    ASSERT_EQ(GetPhiInput(r, pre_header), pre_insts[0]);
+    ASSERT_EQ(pre_insts[0]->GetInput(0).GetInst()->GetId(), P0);
+
+    auto if0 = bb_h->GetLastInst();
+    ASSERT_EQ(if0->GetInput(0).GetInst()->GetId(), I0);
+    ASSERT_EQ(if0->GetInput(1).GetInst()->GetId(), P1);
+}
+
+/*
+    START -> H <-> B
+             |
+             v
+             X
+
+    H:
+        i = PHI(0, i1)
+        IF_IMM i, limit
+    B:
+        j = MULI i, scale
+        CHECK_ZERO j
+        i1 = ADDI i, step
+    X:
+        RETURN_VOID
+*/
+static void BuildScaledLoop(Graph* g, int64_t limit, int64_t scale, int64_t step, IdType* H,
+                            IdType* B)
+{
+    GraphBuilder b(g);
+
+    auto START = Graph::BB_START_ID;
+    auto C0 = b.NewConst(0);
+
+    *H = b.NewBlock();
+    auto I0 = b.NewInst<isa::inst::Opcode::PHI>();
+    auto IF0 = b.NewInst<isa::inst::Opcode::IF_IMM>(Conditional::Type::GEQ);
+
+    *B = b.NewBlock();
+    auto I1 = b.NewInst<isa::inst::Opcode::MULI>();
+    auto I2 = b.NewInst<isa::inst::Opcode::CHECK_ZERO>();
+    auto I3 = b.NewInst<isa::inst::Opcode::ADDI>();
+
+    auto X = b.NewBlock();
+    auto I4 = b.NewInst<isa::inst::Opcode::RETURN_VOID>();
+
+    b.SetInputs(I0, { { C0, START }, { I3, *B } });
+    b.SetInputs(IF0, I0);
+    b.SetImmediate(IF0, 0, static_cast<ImmType>(limit));
+    b.SetInputs(I1, I0);
+    b.SetImmediate(I1, 0, static_cast<ImmType>(scale));
+    b.SetInputs(I2, I1);
+    b.SetInputs(I3, I0);
+    b.SetImmediate(I3, 0, static_cast<ImmType>(step));
+
+    b.SetSuccessors(START, { *H });
+    b.SetSuccessors(*H, { X, *B });
+    b.SetSuccessors(*B, { *H });
+
+    b.ConstructCFG();
+    b.ConstructDFG();
+    b.RunChecks();
+}
+
+TEST(TestStrengthReduction, Overflow)
+{
+    // step * scale overflows, multiplication is kept
+    {
+        Graph g;
+        IdType H = 0;
+        IdType B = 0;
+        BuildScaledLoop(&g, 10, int64_t{ 1 } << 62, 4, &H, &B);
+
+        g.GetPassManager()->Run<StrengthReduction>();
+        g.GetPassManager()->Run<DCE>();
+
+        ASSERT_EQ(CollectPhis(g.GetBasicBlock(H)).size(), 1);
+        auto insts = CollectInsts(g.GetBasicBlock(B));
+        ASSERT_EQ(insts.size(), 3);
+        ASSERT_EQ(insts[0]->GetOpcode(), isa::inst::Opcode::MULI);
+    }
+
+    // i * scale overflows before i reaches the limit, so the exit condition is kept
+    {
+        Graph g;
+        IdType H = 0;
+        IdType B = 0;
+        BuildScaledLoop(&g, int64_t{ 1 } << 61, 8, 1, &H, &B);
+
+        g.GetPassManager()->Run<StrengthReduction>();
+        g.GetPassManager()->Run<DCE>();
+
+        auto bb_h = g.GetBasicBlock(H);
+        auto phis = CollectPhis(bb_h);
+        ASSERT_EQ(phis.size(), 2);
+        auto if0 = bb_h->GetLastInst();
+        ASSERT_EQ(if0->GetInput(0).GetInst(), phis[0]);
+        ASSERT_EQ(static_cast<isa::inst_type::IF_IMM*>(if0)->GetImm(0),
+                  static_cast<ImmType>(int64_t{ 1 } << 61));
+
+        auto insts = CollectInsts(g.GetBasicBlock(B));
+        ASSERT_EQ(insts.size(), 3);
+        ASSERT_EQ(insts[0]->GetOpcode(), isa::inst::Opcode::CHECK_ZERO);
+        ASSERT_EQ(insts[0]->GetInput(0).GetInst(), phis[1]);
+    }
+
+    // the same loop with the smaller limit is rewritten
+    {
+        Graph g;
+        IdType H = 0;
+        IdType B = 0;
+        BuildScaledLoop(&g, int64_t{ 1 } << 59, 8, 1, &H, &B);
+
+        g.GetPassManager()->Run<StrengthReduction>();
+        g.GetPassManager()->Run<DCE>();
+
+        auto bb_h = g.GetBasicBlock(H);
+        auto phis = CollectPhis(bb_h);
+        ASSERT_EQ(phis.size(), 1);
+        auto if0 = bb_h->GetLastInst();
+        ASSERT_EQ(if0->GetInput(0).GetInst(), phis[0]);
+        ASSERT_EQ(static_cast<isa::inst_type::IF_IMM*>(if0)->GetImm(0),
+                  static_cast<ImmType>(int64_t{ 1 } << 62));
+    }
+}
+
+TEST(TestStrengthReduction, InexactImmediates)
+{
+    // i < 2.5 is not i * 2 < 2 * 2, the exit condition is kept
+    {
+        Graph g;
+        IdType H = 0;
+        IdType B = 0;
+        BuildScaledLoop(&g, 10, 2, 1, &H, &B);
+        auto bb_h = g.GetBasicBlock(H);
+        static_cast<isa::inst_type::IF_IMM*>(bb_h->GetLastInst())->SetImmediate(0, 2.5);
+
+        g.GetPassManager()->Run<StrengthReduction>();
+        g.GetPassManager()->Run<DCE>();
+
+        auto phis = CollectPhis(bb_h);
+        ASSERT_EQ(phis.size(), 2);
+        auto if0 = bb_h->GetLastInst();
+        ASSERT_EQ(if0->GetInput(0).GetInst(), phis[0]);
+        ASSERT_EQ(static_cast<isa::inst_type::IF_IMM*>(if0)->GetImm(0), 2.5);
+    }
+
+    // step * scale fits in int64_t, but not in an immediate, multiplication is kept
+    {
+        Graph g;
+        IdType H = 0;
+        IdType B = 0;
+        BuildScaledLoop(&g, 10, (int64_t{ 1 } << 52) + 1, 3, &H, &B);
+
+        g.GetPassManager()->Run<StrengthReduction>();
+        g.GetPassManager()->Run<DCE>();
+
+        ASSERT_EQ(CollectPhis(g.GetBasicBlock(H)).size(), 1);
+        auto insts = CollectInsts(g.GetBasicBlock(B));
+        ASSERT_EQ(insts.size(), 3);
+        ASSERT_EQ(insts[0]->GetOpcode(), isa::inst::Opcode::MULI);
+    }
+}
+
+#pragma GCC diagnostic pop
@@ -13,7 +13,7 @@ class Markable
 {
   public:
     Markable();
-    virtual ~Markable() = default;
+    DEFAULT_DTOR(Markable);
 
     bool ProbeMark(const Marker* marker);
     // true if mark was set, false otherwise
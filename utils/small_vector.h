@@ -0,0 +1,243 @@
+#ifndef __UTILS_SMALL_VECTOR_INCLUDED__
+#define __UTILS_SMALL_VECTOR_INCLUDED__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "utils/macros.h"
+
+// vector, that keeps up to N elements inline and moves them to the heap only when it grows
+// larger. once on the heap, it stays there. inline elements and the heap pointer share the
+// storage, capacity tells which one is used, so the vector takes max(N * sizeof(T), 8) + 8
+// bytes. elements should be trivially copyable. interface follows std::vector, so it works with
+// range-for and standard algorithms
+template <typename T, size_t N>
+class SmallVector
+{
+    STATIC_ASSERT(N > 0);
+    STATIC_ASSERT(std::is_trivially_copyable_v<T>);
+
+  public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector()
+    {
+    }
+
+    SmallVector(const SmallVector& other)
+    {
+        CopyFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other) {
+            Release();
+            CopyFrom(other);
+        }
+        return *this;
+    }
+
+    SmallVector(SmallVector&& other) noexcept
+    {
+        StealFrom(&other);
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other) {
+            Release();
+            StealFrom(&other);
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        Release();
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    bool IsInline() const
+    {
+        return capacity_ == N;
+    }
+
+    T* data()
+    {
+        return IsInline() ? inline_.data() : heap_;
+    }
+
+    const T* data() const
+    {
+        return IsInline() ? inline_.data() : heap_;
+    }
+
+    iterator begin()
+    {
+        return data();
+    }
+
+    iterator end()
+    {
+        return data() + size();
+    }
+
+    const_iterator begin() const
+    {
+        return data();
+    }
+
+    const_iterator end() const
+    {
+        return data() + size();
+    }
+
+    T& operator[](size_t idx)
+    {
+        ASSERT(idx < size());
+        return data()[idx];
+    }
+
+    const T& operator[](size_t idx) const
+    {
+        ASSERT(idx < size());
+        return data()[idx];
+    }
+
+    T& front()
+    {
+        return (*this)[0];
+    }
+
+    const T& front() const
+    {
+        return (*this)[0];
+    }
+
+    T& back()
+    {
+        return (*this)[size() - 1];
+    }
+
+    const T& back() const
+    {
+        return (*this)[size() - 1];
+    }
+
+    void push_back(const T& value)
+    {
+        // value may be an element of the vector itself
+        T copy = value;
+        if (size_ == capacity_) {
+            Grow(2 * capacity_);
+        }
+        data()[size_++] = copy;
+    }
+
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    {
+        push_back(T(std::forward<Args>(args)...));
+    }
+
+    void resize(size_t size)
+    {
+        if (size > capacity_) {
+            Grow(std::max<size_t>(size, 2 * capacity_));
+        }
+        if (size > size_) {
+            std::fill(data() + size_, data() + size, T{});
+        }
+        size_ = static_cast<uint32_t>(size);
+    }
+
+    void clear()
+    {
+        size_ = 0;
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        auto from = first - data();
+        auto to = last - data();
+        std::move(data() + to, end(), data() + from);
+        size_ -= static_cast<uint32_t>(to - from);
+        return data() + from;
+    }
+
+  private:
+    void Grow(size_t capacity)
+    {
+        ASSERT(capacity > capacity_);
+        auto heap = new T[capacity];
+        std::copy(begin(), end(), heap);
+        if (!IsInline()) {
+            delete[] heap_;
+        }
+        heap_ = heap;
+        capacity_ = static_cast<uint32_t>(capacity);
+    }
+
+    // vector becomes empty and inline
+    void Release()
+    {
+        if (!IsInline()) {
+            delete[] heap_;
+            inline_ = {};
+        }
+        size_ = 0;
+        capacity_ = N;
+    }
+
+    void CopyFrom(const SmallVector& other)
+    {
+        ASSERT(IsInline() && empty());
+        if (!other.IsInline()) {
+            heap_ = new T[other.capacity_];
+            capacity_ = other.capacity_;
+        }
+        std::copy(other.begin(), other.end(), data());
+        size_ = other.size_;
+    }
+
+    void StealFrom(SmallVector* other)
+    {
+        ASSERT(IsInline() && empty());
+        if (other->IsInline()) {
+            inline_ = other->inline_;
+        } else {
+            heap_ = other->heap_;
+            capacity_ = other->capacity_;
+            other->inline_ = {};
+            other->capacity_ = N;
+        }
+        size_ = other->size_;
+        other->size_ = 0;
+    }
+
+    union
+    {
+        std::array<T, N> inline_{};
+        T* heap_;
+    };
+    uint32_t size_{ 0 };
+    uint32_t capacity_{ N };
+};
+
+#endif